@@ -0,0 +1,196 @@
+#include <benchmark/benchmark.h>
+#include "bench_utils.hpp"
+#include "database.hpp"
+
+namespace benchmarks
+{
+  namespace
+  {
+    struct Statement
+    {
+      const char* name;
+      const char* query;
+    };
+
+    constexpr Statement insert_statement = {
+      "bench_insert_task",
+      "INSERT INTO tasks (title, description, status, created_at) VALUES ($1, $2, $3, $4) RETURNING id"
+    };
+    constexpr Statement operation_statements[] = {
+      { "bench_get_task", "SELECT id, title, description, status, created_at, version FROM tasks WHERE id = $1" },
+      { "bench_update_task", "UPDATE tasks SET status = COALESCE($2, status), version = version + 1 WHERE id = $1 RETURNING version" },
+      { "bench_delete_task", "DELETE FROM tasks WHERE id = $1 RETURNING id" }
+    };
+    constexpr const char* operation_labels[] = { "GET", "PUT", "DELETE" };
+
+    pqxx::result execute(pqxx::transaction_base& txn, const Statement& statement, bool prepared, const pqxx::params& params)
+    {
+      return prepared ? txn.exec(pqxx::prepped{ statement.name }, params) : txn.exec(statement.query, params);
+    }
+
+    int insert_task(pqxx::connection& connection, bool prepared)
+    {
+      pqxx::work txn(connection);
+      auto result = execute(txn, insert_statement, prepared, pqxx::params{ "Benchmark task", "", "Todo", 1700000000LL });
+      txn.commit();
+      return result[0][0].as< int >();
+    }
+  }
+
+  // Single-task GET/PUT/DELETE statements as the handlers run them, with and without server-side preparation.
+  // Needs the same Postgres as the tests; reports an error when it is not reachable.
+  void BM_TaskStatement(benchmark::State& state)
+  {
+    size_t operation = static_cast< size_t >(state.range(0));
+    bool prepared = state.range(1);
+    const Statement& statement = operation_statements[operation];
+    state.SetLabel(operation_labels[operation]);
+
+    std::unique_ptr< pqxx::connection > connection;
+    int task_id = 0;
+    try
+    {
+      database::Database(get_connection_string()).initialize_database();
+      connection = std::make_unique< pqxx::connection >(get_connection_string());
+      if (prepared)
+      {
+        connection->prepare(insert_statement.name, insert_statement.query);
+        connection->prepare(statement.name, statement.query);
+      }
+      task_id = insert_task(*connection, prepared);
+    }
+    catch (const std::exception& e)
+    {
+      state.SkipWithError(("Can't connect to database: " + std::string(e.what())).c_str());
+      return;
+    }
+
+    for (auto _ : state)
+    {
+      if (operation == 2)
+      {
+        state.PauseTiming();
+        task_id = insert_task(*connection, prepared);
+        state.ResumeTiming();
+      }
+
+      if (operation == 0)
+      {
+        pqxx::read_transaction txn(*connection);
+        benchmark::DoNotOptimize(execute(txn, statement, prepared, pqxx::params{ task_id }));
+      }
+      else
+      {
+        pqxx::work txn(*connection);
+        auto params = operation == 1 ? pqxx::params{ task_id, "In progress" } : pqxx::params{ task_id };
+        benchmark::DoNotOptimize(execute(txn, statement, prepared, params));
+        txn.commit();
+      }
+    }
+
+    if (operation != 2)
+    {
+      pqxx::work txn(*connection);
+      txn.exec(operation_statements[2].query, pqxx::params{ task_id });
+      txn.commit();
+    }
+    state.SetItemsProcessed(state.iterations());
+  }
+  BENCHMARK(BM_TaskStatement)
+    ->ArgNames({ "operation", "prepared" })
+    ->ArgsProduct({ { 0, 1, 2 }, { 0, 1 } })
+    ->UseRealTime();
+
+  // Independent reads sent one roundtrip at a time against the same reads queued on a pqxx::pipeline.
+  // The gap grows with the connection latency, e.g. under `tc qdisc add dev lo root netem delay 1ms`.
+  void BM_StatementRoundTrips(benchmark::State& state)
+  {
+    size_t statements = static_cast< size_t >(state.range(0));
+    bool pipelined = state.range(1);
+
+    std::unique_ptr< pqxx::connection > connection;
+    int task_id = 0;
+    try
+    {
+      database::Database(get_connection_string()).initialize_database();
+      connection = std::make_unique< pqxx::connection >(get_connection_string());
+      task_id = insert_task(*connection, false);
+    }
+    catch (const std::exception& e)
+    {
+      state.SkipWithError(("Can't connect to database: " + std::string(e.what())).c_str());
+      return;
+    }
+
+    // pqxx::pipeline takes plain query text, so both variants inline the id
+    std::string query = "SELECT id, title, description, status, created_at, version FROM tasks WHERE id = " +
+      std::to_string(task_id);
+
+    for (auto _ : state)
+    {
+      pqxx::read_transaction txn(*connection);
+      if (pipelined)
+      {
+        pqxx::pipeline pipeline(txn);
+        for (size_t i = 0; i != statements; ++i)
+        {
+          pipeline.insert(query);
+        }
+        pipeline.complete();
+        while (!pipeline.empty())
+        {
+          benchmark::DoNotOptimize(pipeline.retrieve());
+        }
+      }
+      else
+      {
+        for (size_t i = 0; i != statements; ++i)
+        {
+          benchmark::DoNotOptimize(txn.exec(query));
+        }
+      }
+    }
+
+    pqxx::work txn(*connection);
+    txn.exec(operation_statements[2].query, pqxx::params{ task_id });
+    txn.commit();
+    state.SetItemsProcessed(state.iterations() * statements);
+  }
+  BENCHMARK(BM_StatementRoundTrips)
+    ->ArgNames({ "statements", "pipelined" })
+    ->ArgsProduct({ { 1, 4, 16 }, { 0, 1 } })
+    ->UseRealTime();
+
+  // Database::create_tasks end to end: COPY into the per-connection import table plus one INSERT ... SELECT.
+  void BM_CreateTasksBatch(benchmark::State& state)
+  {
+    auto tasks = make_tasks(static_cast< size_t >(state.range(0)));
+
+    std::unique_ptr< database::Database > db;
+    std::unique_ptr< pqxx::connection > connection;
+    try
+    {
+      db = std::make_unique< database::Database >(get_connection_string());
+      db->initialize_database();
+      connection = std::make_unique< pqxx::connection >(get_connection_string());
+    }
+    catch (const std::exception& e)
+    {
+      state.SkipWithError(("Can't connect to database: " + std::string(e.what())).c_str());
+      return;
+    }
+
+    for (auto _ : state)
+    {
+      auto ids = db->create_tasks(tasks);
+
+      state.PauseTiming();
+      pqxx::work txn(*connection);
+      txn.exec("DELETE FROM tasks WHERE id = ANY($1::INT[])", pqxx::params{ ids });
+      txn.commit();
+      state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * tasks.size());
+  }
+  BENCHMARK(BM_CreateTasksBatch)->ArgName("tasks")->Arg(1)->Arg(100)->Arg(1000)->UseRealTime();
+}
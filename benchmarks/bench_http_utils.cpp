@@ -0,0 +1,97 @@
+#include <benchmark/benchmark.h>
+#include "bench_utils.hpp"
+#include "compression.hpp"
+#include "http_utils.hpp"
+
+namespace benchmarks
+{
+  void BM_ParseParameters(benchmark::State& state)
+  {
+    beast::string_view target = "/task/12345/history?limit=100&cursor=abc";
+    for (auto _ : state)
+    {
+      benchmark::DoNotOptimize(utils::parse_parameters(target));
+    }
+  }
+  BENCHMARK(BM_ParseParameters);
+
+  void BM_ParseQuery(benchmark::State& state)
+  {
+    beast::string_view target = "/tasks?limit=100&cursor=MTcwMDAwMDAwMDoxMjM&status=In%20progress";
+    for (auto _ : state)
+    {
+      benchmark::DoNotOptimize(utils::parse_query(target));
+    }
+  }
+  BENCHMARK(BM_ParseQuery);
+
+  void BM_StringToStatus(benchmark::State& state)
+  {
+    const std::vector< std::string > statuses = { "Todo", "In progress", "Completed", "Unknown" };
+    size_t i = 0;
+    for (auto _ : state)
+    {
+      benchmark::DoNotOptimize(utils::string_to_status(statuses[i++ & 3]));
+    }
+  }
+  BENCHMARK(BM_StringToStatus);
+
+  void BM_CreateResponse(benchmark::State& state)
+  {
+    bool is_error = state.range(0);
+    for (auto _ : state)
+    {
+      benchmark::DoNotOptimize(utils::create_response(is_error ? http::status::bad_request : http::status::created, is_error,
+        "12345"));
+    }
+  }
+  BENCHMARK(BM_CreateResponse)->ArgName("error")->Arg(0)->Arg(1);
+
+  void BM_CreateJsonResponse(benchmark::State& state)
+  {
+    nlohmann::json json = make_tasks(static_cast< size_t >(state.range(0)));
+    for (auto _ : state)
+    {
+      benchmark::DoNotOptimize(utils::create_json_response(http::status::ok, json));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+  }
+  BENCHMARK(BM_CreateJsonResponse)->Arg(1)->Arg(100);
+
+  void BM_CreateRawJsonResponse(benchmark::State& state)
+  {
+    std::string body;
+    database::append_json(body, make_tasks(static_cast< size_t >(state.range(0))));
+    for (auto _ : state)
+    {
+      benchmark::DoNotOptimize(utils::create_raw_json_response(http::status::ok, body));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+  }
+  BENCHMARK(BM_CreateRawJsonResponse)->Arg(1)->Arg(100);
+
+  void BM_Compress(benchmark::State& state)
+  {
+    auto encoding = static_cast< utils::ContentEncoding >(state.range(0));
+    int level = static_cast< int >(state.range(1));
+
+    std::string body;
+    database::append_json(body, make_tasks(1000));
+
+    size_t compressed_size = 0;
+    for (auto _ : state)
+    {
+      std::string compressed = utils::compress(body, encoding, level);
+      compressed_size = compressed.size();
+      benchmark::DoNotOptimize(compressed);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast< int64_t >(body.size()));
+    state.counters["ratio"] = static_cast< double >(compressed_size) / static_cast< double >(body.size());
+  }
+  BENCHMARK(BM_Compress)
+    ->ArgNames({ "encoding", "level" })
+    ->Args({ static_cast< int64_t >(utils::ContentEncoding::GZIP), 1 })
+    ->Args({ static_cast< int64_t >(utils::ContentEncoding::GZIP), 6 })
+    ->Args({ static_cast< int64_t >(utils::ContentEncoding::GZIP), 9 })
+    ->Args({ static_cast< int64_t >(utils::ContentEncoding::DEFLATE), 6 });
+}
@@ -0,0 +1,63 @@
+#include <benchmark/benchmark.h>
+#include "logger.hpp"
+#include "server.hpp"
+
+namespace benchmarks
+{
+  void BM_LogMessage(benchmark::State& state)
+  {
+    auto& logger = logger::Logger::get_instance();
+    if (state.thread_index() == 0)
+    {
+      logger.set_overflow_policy(logger::OverflowPolicy::BLOCK);
+    }
+
+    for (auto _ : state)
+    {
+      LOG(logger::LogLevel::INFO, "Task {} updated to version {}", 12345, 7);
+    }
+
+    if (state.thread_index() == 0)
+    {
+      logger.flush();
+    }
+  }
+  BENCHMARK(BM_LogMessage)->Threads(1)->Threads(16)->UseRealTime();
+
+  void BM_LogSuppressed(benchmark::State& state)
+  {
+    std::string message = "Response created";
+    for (auto _ : state)
+    {
+      LOG(logger::LogLevel::DEBUG, "{}: {}", message, 12345);
+    }
+  }
+  BENCHMARK(BM_LogSuppressed)->Threads(1)->Threads(16)->UseRealTime();
+
+  // Logging done for one request/response: request and response lines plus the suppressed DEBUG response line.
+  void BM_LogRequest(benchmark::State& state)
+  {
+    auto& logger = logger::Logger::get_instance();
+    auto policy = state.range(0) ? logger::OverflowPolicy::BLOCK : logger::OverflowPolicy::DROP;
+    uint64_t dropped = logger.get_dropped();
+    if (state.thread_index() == 0)
+    {
+      logger.set_overflow_policy(policy);
+    }
+
+    http::request< http::string_body > req(http::verb::get, "/task/12345", 11);
+    for (auto _ : state)
+    {
+      server::log_connection("Request", req);
+      LOG(logger::LogLevel::DEBUG, "Response created. Info: {}", "12345");
+      server::log_connection("Response", req);
+    }
+
+    if (state.thread_index() == 0)
+    {
+      logger.flush();
+      state.counters["dropped"] = static_cast< double >(logger.get_dropped() - dropped);
+    }
+  }
+  BENCHMARK(BM_LogRequest)->ArgName("block")->Arg(0)->Arg(1)->Threads(1)->Threads(16)->UseRealTime();
+}
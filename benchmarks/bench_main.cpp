@@ -0,0 +1,119 @@
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include "logger.hpp"
+
+namespace
+{
+  std::atomic< int64_t > allocations(0);
+  std::atomic< int64_t > allocated_bytes(0);
+
+  void* counted_allocate(std::size_t size)
+  {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    allocated_bytes.fetch_add(static_cast< int64_t >(size), std::memory_order_relaxed);
+    if (void* pointer = std::malloc(size == 0 ? 1 : size))
+    {
+      return pointer;
+    }
+    throw std::bad_alloc();
+  }
+
+  // Reports allocs_per_iter for every benchmark; server benchmarks include the server threads' allocations
+  class AllocationCounter: public benchmark::MemoryManager
+  {
+  public:
+    void Start() override
+    {
+      allocations_at_start_ = allocations.load(std::memory_order_relaxed);
+      bytes_at_start_ = allocated_bytes.load(std::memory_order_relaxed);
+    }
+
+    void Stop(Result& result) override
+    {
+      result.num_allocs = allocations.load(std::memory_order_relaxed) - allocations_at_start_;
+      result.total_allocated_bytes = allocated_bytes.load(std::memory_order_relaxed) - bytes_at_start_;
+      result.max_bytes_used = benchmark::MemoryManager::TombstoneValue;
+      result.net_heap_growth = benchmark::MemoryManager::TombstoneValue;
+    }
+
+  private:
+    int64_t allocations_at_start_ = 0;
+    int64_t bytes_at_start_ = 0;
+  };
+
+  class NullBuffer: public std::streambuf
+  {
+  protected:
+    int overflow(int c) override
+    {
+      return traits_type::not_eof(c);
+    }
+
+    std::streamsize xsputn(const char*, std::streamsize count) override
+    {
+      return count;
+    }
+  };
+}
+
+void* operator new(std::size_t size)
+{
+  return counted_allocate(size);
+}
+
+void* operator new[](std::size_t size)
+{
+  return counted_allocate(size);
+}
+
+void operator delete(void* pointer) noexcept
+{
+  std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+  std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+  std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept
+{
+  std::free(pointer);
+}
+
+int main(int argc, char** argv)
+{
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv))
+  {
+    return 1;
+  }
+
+  // The logger writes to std::cout, so the console report gets its own stream and log lines are discarded.
+  std::streambuf* stdout_buffer = std::cout.rdbuf();
+  std::ostream report(stdout_buffer);
+  NullBuffer null_buffer;
+  std::cout.rdbuf(&null_buffer);
+
+  AllocationCounter allocation_counter;
+  benchmark::RegisterMemoryManager(&allocation_counter);
+
+  benchmark::ConsoleReporter reporter;
+  reporter.SetOutputStream(&report);
+  reporter.SetErrorStream(&std::cerr);
+  benchmark::RunSpecifiedBenchmarks(&reporter);
+
+  logger::Logger::get_instance().flush();
+  std::cout.rdbuf(stdout_buffer);
+  benchmark::RegisterMemoryManager(nullptr);
+  benchmark::Shutdown();
+  return 0;
+}
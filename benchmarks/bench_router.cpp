@@ -0,0 +1,111 @@
+#include <benchmark/benchmark.h>
+#include "http_utils.hpp"
+#include "router.hpp"
+
+namespace benchmarks
+{
+  namespace
+  {
+    const std::vector< std::pair< http::verb, std::string > > requests = {
+      { http::verb::get, "/tasks?limit=100" },
+      { http::verb::get, "/task/12345" },
+      { http::verb::put, "/task" },
+      { http::verb::delete_, "/task/7" },
+      { http::verb::post, "/tasks/batch" },
+      { http::verb::get, "/not_found" }
+    };
+
+    // Stand-in for the former HandlerFactory: every handler parses the target in can_handle,
+    // and the first match is cloned with create() for each request
+    class FactoryHandler
+    {
+    public:
+      FactoryHandler(http::verb method, size_t size, std::string_view resource):
+        method_(method),
+        size_(size),
+        resource_(resource)
+      {}
+
+      bool can_handle(const http::request< http::string_body >& req) const
+      {
+        auto params = utils::parse_parameters(req.target());
+        return req.method() == method_ && params.size() == size_ && params[1] == resource_;
+      }
+
+      std::unique_ptr< FactoryHandler > create() const
+      {
+        return std::make_unique< FactoryHandler >(*this);
+      }
+
+    private:
+      http::verb method_;
+      size_t size_;
+      std::string_view resource_;
+    };
+
+    class HandlerFactory
+    {
+    public:
+      HandlerFactory():
+        handlers_()
+      {
+        handlers_.push_back(std::make_unique< FactoryHandler >(http::verb::delete_, 3, "task"));
+        handlers_.push_back(std::make_unique< FactoryHandler >(http::verb::get, 3, "task"));
+        handlers_.push_back(std::make_unique< FactoryHandler >(http::verb::get, 2, "tasks"));
+        handlers_.push_back(std::make_unique< FactoryHandler >(http::verb::post, 2, "task"));
+        handlers_.push_back(std::make_unique< FactoryHandler >(http::verb::put, 2, "task"));
+        handlers_.push_back(std::make_unique< FactoryHandler >(http::verb::post, 3, "tasks"));
+      }
+
+      std::unique_ptr< FactoryHandler > create_handler(const http::request< http::string_body >& req) const
+      {
+        for (size_t i = 0; i != handlers_.size(); ++i)
+        {
+          if (handlers_[i]->can_handle(req))
+          {
+            return handlers_[i]->create();
+          }
+        }
+        return nullptr;
+      }
+
+    private:
+      std::vector< std::unique_ptr< FactoryHandler > > handlers_;
+    };
+
+    std::vector< http::request< http::string_body > > make_requests()
+    {
+      std::vector< http::request< http::string_body > > result;
+      for (const auto& [method, target] : requests)
+      {
+        result.emplace_back(method, target, 11);
+      }
+      return result;
+    }
+  }
+
+  void BM_RouterMatch(benchmark::State& state)
+  {
+    auto router = handlers::Router::create_default();
+    size_t i = 0;
+    for (auto _ : state)
+    {
+      const auto& [method, target] = requests[i++ % requests.size()];
+      benchmark::DoNotOptimize(router.match(method, target));
+    }
+  }
+  BENCHMARK(BM_RouterMatch);
+
+  // Baseline for BM_RouterMatch: linear can_handle scan plus a handler allocation per request
+  void BM_HandlerFactoryMatch(benchmark::State& state)
+  {
+    HandlerFactory factory;
+    auto factory_requests = make_requests();
+    size_t i = 0;
+    for (auto _ : state)
+    {
+      benchmark::DoNotOptimize(factory.create_handler(factory_requests[i++ % factory_requests.size()]));
+    }
+  }
+  BENCHMARK(BM_HandlerFactoryMatch);
+}
@@ -0,0 +1,168 @@
+#include <benchmark/benchmark.h>
+#include "bench_utils.hpp"
+#include "server.hpp"
+
+namespace benchmarks
+{
+  namespace
+  {
+    constexpr unsigned short server_port = 9100;
+
+    struct ServerState
+    {
+      std::shared_ptr< database::Database > db;
+      std::unique_ptr< server::Server > server;
+      int task_id = 0;
+    };
+
+    std::unique_ptr< ServerState > server_state;
+    std::string server_error;
+
+    void start_server(server::SessionMode session_mode, bool reuse_port, size_t threads_num)
+    {
+      server_error.clear();
+      try
+      {
+        auto state = std::make_unique< ServerState >();
+
+        database::DatabaseConfig db_config;
+        db_config.pool.max_size = 16;
+        state->db = std::make_shared< database::Database >(get_connection_string(), db_config);
+        state->db->initialize_database();
+
+        database::Task task;
+        task.set_title("Benchmark task");
+        task.set_description("Task read by the server benchmarks");
+        task.set_status("Todo");
+        state->task_id = state->db->create_task(task);
+
+        server::ServerConfig config;
+        config.db_threads_num = 16;
+        config.session_mode = session_mode;
+        config.reuse_port = reuse_port;
+        state->server = std::make_unique< server::Server >("127.0.0.1", server_port, threads_num, state->db, config);
+        state->server->start();
+
+        server_state = std::move(state);
+      }
+      catch (const std::exception& e)
+      {
+        server_error = e.what();
+      }
+    }
+
+    void stop_server()
+    {
+      if (server_state)
+      {
+        server_state->server->stop();
+        server_state->db->delete_task(server_state->task_id);
+        server_state.reset();
+      }
+    }
+
+    void server_arguments(benchmark::internal::Benchmark* benchmark)
+    {
+      const std::vector< std::pair< int, int > > modes = { { 0, 0 }, { 1, 0 }, { 0, 1 } };
+      for (const auto& [coroutine, reuse_port] : modes)
+      {
+        for (int server_threads : { 1, 4, 16 })
+        {
+          for (int connect_per_request : { 0, 1 })
+          {
+            benchmark->Args({ coroutine, reuse_port, server_threads, connect_per_request });
+          }
+        }
+      }
+    }
+  }
+
+  // End-to-end GET /task/{id}, one client per benchmark thread, against 1/4/16 server threads. The client either keeps
+  // one connection alive or connects for every request, which measures the accept rate.
+  // p50_us/p99_us are per-request latencies of each client thread, averaged over the threads.
+  // Needs the same Postgres as the tests; reports an error when it is not reachable.
+  void BM_ServerGetTask(benchmark::State& state)
+  {
+    bool connect_per_request = state.range(3);
+    if (state.thread_index() == 0)
+    {
+      start_server(state.range(0) ? server::SessionMode::COROUTINE : server::SessionMode::CALLBACK, state.range(1),
+        static_cast< size_t >(state.range(2)));
+    }
+
+    net::io_context ioc;
+    beast::tcp_stream stream(ioc);
+    beast::flat_buffer buffer;
+    bool connected = false;
+    std::vector< double > latencies;
+
+    for (auto _ : state)
+    {
+      auto started = std::chrono::steady_clock::now();
+      if (!server_state)
+      {
+        state.SkipWithError(("Can't start server: " + server_error).c_str());
+        break;
+      }
+
+      try
+      {
+        if (!connected)
+        {
+          stream.connect(tcp::endpoint(net::ip::make_address("127.0.0.1"), server_port));
+          connected = true;
+        }
+
+        http::request< http::empty_body > req(http::verb::get, "/task/" + std::to_string(server_state->task_id), 11);
+        req.set(http::field::host, "127.0.0.1");
+        req.keep_alive(!connect_per_request);
+        http::write(stream, req);
+
+        http::response< http::string_body > res;
+        http::read(stream, buffer, res);
+        if (res.result() != http::status::ok)
+        {
+          state.SkipWithError(("Unexpected status " + std::to_string(res.result_int())).c_str());
+          break;
+        }
+
+        if (connect_per_request)
+        {
+          beast::error_code ec;
+          stream.socket().shutdown(tcp::socket::shutdown_both, ec);
+          stream.close();
+          buffer.clear();
+          connected = false;
+        }
+        latencies.push_back(std::chrono::duration< double, std::micro >(std::chrono::steady_clock::now() - started).count());
+      }
+      catch (const std::exception& e)
+      {
+        state.SkipWithError(e.what());
+        break;
+      }
+    }
+
+    beast::error_code ec;
+    stream.socket().shutdown(tcp::socket::shutdown_both, ec);
+    state.SetItemsProcessed(state.iterations());
+    state.counters["p50_us"] = benchmark::Counter(percentile(latencies, 0.5), benchmark::Counter::kAvgThreads);
+    state.counters["p99_us"] = benchmark::Counter(percentile(latencies, 0.99), benchmark::Counter::kAvgThreads);
+    if (connect_per_request)
+    {
+      state.counters["accepts"] = benchmark::Counter(static_cast< double >(state.iterations()), benchmark::Counter::kIsRate);
+    }
+
+    if (state.thread_index() == 0)
+    {
+      stop_server();
+    }
+  }
+  BENCHMARK(BM_ServerGetTask)
+    ->ArgNames({ "coroutine", "reuse_port", "server_threads", "connect_per_request" })
+    ->Apply(server_arguments)
+    ->Threads(1)
+    ->Threads(4)
+    ->Threads(16)
+    ->UseRealTime();
+}
@@ -0,0 +1,79 @@
+#include <benchmark/benchmark.h>
+#include "bench_utils.hpp"
+
+namespace benchmarks
+{
+  void BM_TaskToJson(benchmark::State& state)
+  {
+    auto tasks = make_tasks(static_cast< size_t >(state.range(0)));
+    for (auto _ : state)
+    {
+      nlohmann::json json = tasks;
+      benchmark::DoNotOptimize(json);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+  }
+  BENCHMARK(BM_TaskToJson)->Arg(1)->Arg(10000);
+
+  void BM_TaskToJsonDump(benchmark::State& state)
+  {
+    auto tasks = make_tasks(static_cast< size_t >(state.range(0)));
+    for (auto _ : state)
+    {
+      nlohmann::json json = tasks;
+      benchmark::DoNotOptimize(json.dump());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+  }
+  BENCHMARK(BM_TaskToJsonDump)->Arg(1)->Arg(10000);
+
+  void BM_AppendJson(benchmark::State& state)
+  {
+    auto tasks = make_tasks(static_cast< size_t >(state.range(0)));
+    std::string buffer;
+    for (auto _ : state)
+    {
+      buffer.clear();
+      database::append_json(buffer, tasks);
+      benchmark::DoNotOptimize(buffer.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+  }
+  BENCHMARK(BM_AppendJson)->Arg(1)->Arg(10000);
+
+  void BM_TaskFromJson(benchmark::State& state)
+  {
+    nlohmann::json json = make_tasks(static_cast< size_t >(state.range(0)));
+    for (auto _ : state)
+    {
+      benchmark::DoNotOptimize(json.get< std::vector< database::Task > >());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+  }
+  BENCHMARK(BM_TaskFromJson)->Arg(1)->Arg(10000);
+
+  void BM_ParseTaskNlohmann(benchmark::State& state)
+  {
+    std::string body = nlohmann::json(make_task(1)).dump();
+    for (auto _ : state)
+    {
+      database::Task task = nlohmann::json::parse(body).get< database::Task >();
+      benchmark::DoNotOptimize(task);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast< int64_t >(body.size()));
+  }
+  BENCHMARK(BM_ParseTaskNlohmann);
+
+  void BM_ParseTaskSimdjson(benchmark::State& state)
+  {
+    std::string body = nlohmann::json(make_task(1)).dump();
+    for (auto _ : state)
+    {
+      database::Task task;
+      database::parse_task(body, task);
+      benchmark::DoNotOptimize(task);
+    }
+    state.SetBytesProcessed(state.iterations() * static_cast< int64_t >(body.size()));
+  }
+  BENCHMARK(BM_ParseTaskSimdjson);
+}
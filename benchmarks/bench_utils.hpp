@@ -0,0 +1,60 @@
+#ifndef BENCH_UTILS_HPP
+#define BENCH_UTILS_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include "task.hpp"
+
+namespace benchmarks
+{
+  inline database::Task make_task(int id)
+  {
+    database::Task task(id, "Task " + std::to_string(id), "Description of task " + std::to_string(id) + " with \"quotes\"",
+      id % 3 == 0 ? "Todo" : (id % 3 == 1 ? "In progress" : "Completed"),
+      std::chrono::system_clock::time_point(std::chrono::seconds(1700000000 + id)));
+    task.set_version(1 + id % 5);
+    return task;
+  }
+
+  inline std::vector< database::Task > make_tasks(size_t count)
+  {
+    std::vector< database::Task > tasks;
+    tasks.reserve(count);
+    for (size_t i = 0; i != count; ++i)
+    {
+      tasks.push_back(make_task(static_cast< int >(i) + 1));
+    }
+    return tasks;
+  }
+
+  inline double percentile(std::vector< double >& samples, double fraction)
+  {
+    if (samples.empty())
+    {
+      return 0.0;
+    }
+    auto position = samples.begin() + static_cast< std::ptrdiff_t >(fraction * static_cast< double >(samples.size() - 1));
+    std::nth_element(samples.begin(), position, samples.end());
+    return *position;
+  }
+
+  inline std::string get_connection_string()
+  {
+    std::string db_host = std::getenv("DB_HOST") ? std::getenv("DB_HOST") : "localhost";
+    std::string db_port = std::getenv("DB_PORT") ? std::getenv("DB_PORT") : "5432";
+    std::string db_name = std::getenv("DB_NAME") ? std::getenv("DB_NAME") : "dbtest";
+    std::string db_user = std::getenv("DB_USER") ? std::getenv("DB_USER") : "postgres";
+    std::string db_password = std::getenv("DB_PASSWORD") ? std::getenv("DB_PASSWORD") : "admin";
+
+    return "host=" + db_host +
+      " port=" + db_port +
+      " dbname=" + db_name +
+      " user=" + db_user +
+      " password=" + db_password;
+  }
+}
+
+#endif
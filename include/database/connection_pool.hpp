@@ -0,0 +1,108 @@
+#ifndef CONNECTION_POOL_HPP
+#define CONNECTION_POOL_HPP
+
+#include <pqxx/pqxx>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace database
+{
+  struct PoolConfig
+  {
+    size_t min_size = 1;
+    size_t max_size = 4;
+    std::chrono::milliseconds checkout_timeout = std::chrono::milliseconds(5000);
+    std::chrono::milliseconds health_check_interval = std::chrono::milliseconds(30000);
+  };
+
+  struct PoolStats
+  {
+    size_t size = 0;
+    size_t idle = 0;
+    size_t in_use = 0;
+    size_t max_size = 0;
+    size_t waiting = 0;
+    uint64_t checkouts = 0;
+    uint64_t timeouts = 0;
+    uint64_t reconnects = 0;
+    std::chrono::nanoseconds total_wait = std::chrono::nanoseconds::zero();
+    std::chrono::nanoseconds max_wait = std::chrono::nanoseconds::zero();
+
+    double utilization() const;
+    std::chrono::nanoseconds average_wait() const;
+  };
+
+  class ConnectionPool;
+
+  using ConnectionInitializer = std::function< void(pqxx::connection&) >;
+
+  class PooledConnection
+  {
+  public:
+    PooledConnection(ConnectionPool& pool, std::unique_ptr< pqxx::connection > connection, uint64_t generation);
+    PooledConnection(PooledConnection&& other) noexcept;
+    PooledConnection(const PooledConnection&) = delete;
+    PooledConnection& operator=(const PooledConnection&) = delete;
+    PooledConnection& operator=(PooledConnection&&) = delete;
+    ~PooledConnection();
+
+    pqxx::connection& operator*() const;
+    pqxx::connection* operator->() const;
+
+  private:
+    ConnectionPool* pool_;
+    std::unique_ptr< pqxx::connection > connection_;
+    uint64_t generation_;
+  };
+
+  class ConnectionPool
+  {
+    friend class PooledConnection;
+
+  public:
+    ConnectionPool(const std::string& connection_string, const PoolConfig& config);
+    ~ConnectionPool() = default;
+
+    PooledConnection acquire();
+    PoolStats get_stats() const;
+    void set_initializer(ConnectionInitializer initializer);
+
+  private:
+    struct IdleConnection
+    {
+      std::unique_ptr< pqxx::connection > connection;
+      std::chrono::steady_clock::time_point last_used;
+      uint64_t generation = 0;
+    };
+
+    std::string connection_string_;
+    PoolConfig config_;
+
+    mutable std::mutex pool_mutex_;
+    std::condition_variable available_;
+    std::vector< IdleConnection > idle_;
+    size_t size_;
+    size_t waiting_;
+    std::shared_ptr< const ConnectionInitializer > initializer_;
+    uint64_t generation_;
+
+    uint64_t checkouts_;
+    uint64_t timeouts_;
+    uint64_t reconnects_;
+    std::chrono::nanoseconds total_wait_;
+    std::chrono::nanoseconds max_wait_;
+
+    std::unique_ptr< pqxx::connection > open_connection();
+    std::unique_ptr< pqxx::connection > check_health(IdleConnection idle);
+    void release(std::unique_ptr< pqxx::connection > connection, uint64_t generation);
+    void record_wait(std::chrono::nanoseconds wait);
+  };
+}
+
+#endif
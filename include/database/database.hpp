@@ -1,86 +1,131 @@
 #ifndef DATABASE_HPP
 #define DATABASE_HPP
 
-#include <nlohmann/json.hpp>
 #include <pqxx/pqxx>
+#include <atomic>
 #include <string>
 #include <chrono>
+#include <thread>
+#include "connection_pool.hpp"
+#include "group_committer.hpp"
+#include "task.hpp"
+#include "task_cache.hpp"
 
-namespace nlohmann
+namespace database
 {
-  template<>
-  struct adl_serializer< std::chrono::system_clock::time_point >
+  struct TaskCursor
   {
-    static void to_json(json& j, const std::chrono::system_clock::time_point& tp)
-    {
-      auto seconds = std::chrono::duration_cast< std::chrono::seconds >(tp.time_since_epoch()).count();
-      j = seconds;
-    }
-
-    static void from_json(const json& j, std::chrono::system_clock::time_point& tp)
-    {
-      auto seconds = j.get< long long >();
-      tp = std::chrono::system_clock::time_point(std::chrono::seconds(seconds));
-    }
+    long long created_at;
+    int id;
   };
-}
 
-namespace database
-{
-  class Task
+  std::string encode_cursor(const TaskCursor& cursor);
+  std::optional< TaskCursor > decode_cursor(std::string_view cursor);
+
+  struct TaskQuery
+  {
+    std::optional< size_t > limit;
+    std::optional< TaskCursor > cursor;
+    std::optional< std::string > status;
+  };
+
+  struct TaskPage
+  {
+    std::vector< Task > tasks;
+    std::optional< TaskCursor > next_cursor;
+  };
+
+  class TaskNotFoundError: public std::runtime_error
+  {
+  public:
+    explicit TaskNotFoundError(int id);
+  };
+
+  class VersionConflictError: public std::runtime_error
   {
-    friend void to_json(nlohmann::json& j, const Task& t);
-    friend void from_json(const nlohmann::json&, Task& t);
+  public:
+    VersionConflictError(int id, const std::vector< int >& expected_versions);
+  };
 
+  class TaskStream
+  {
   public:
-    Task() = default;
-    Task(int id);
-    Task(int id, std::string title, std::string description, std::string status, std::chrono::system_clock::time_point created_at);
-    ~Task() = default;
-
-    std::optional< int > get_id() const;
-    std::optional< std::string > get_title() const;
-    std::optional< std::string > get_description() const;
-    std::optional< std::string > get_status() const;
-    std::chrono::system_clock::time_point get_created_at() const;
-
-    void set_id(const std::optional< int >& id);
-    void set_title(const std::optional< std::string >& title);
-    void set_description(const std::optional< std::string >& description);
-    void set_status(const std::optional< std::string >& status);
+    TaskStream(PooledConnection connection, std::atomic< size_t >& active_streams, const std::optional< std::string >& status,
+      size_t batch_size);
+    TaskStream(const TaskStream&) = delete;
+    TaskStream& operator=(const TaskStream&) = delete;
+    ~TaskStream();
+
+    std::vector< Task > fetch();
+    bool is_finished() const;
 
   private:
-    std::optional< int > id_;
-    std::optional< std::string > title_;
-    std::optional< std::string > description_;
-    std::optional< std::string > status_;
-    std::chrono::system_clock::time_point created_at_;
+    PooledConnection connection_;
+    std::atomic< size_t >& active_streams_;
+    pqxx::read_transaction txn_;
+    size_t batch_size_;
+    std::optional< pqxx::result > prefetched_;
+    bool finished_;
+
+    std::string fetch_query() const;
   };
 
-  void to_json(nlohmann::json& j, const Task& t);
-  void from_json(const nlohmann::json&, Task& t);
+  struct DatabaseConfig
+  {
+    PoolConfig pool;
+    size_t cache_capacity = 0;
+    size_t cache_shards = 16;
+    GroupCommitConfig group_commit;
+    size_t max_streams = 0;
+  };
 
   class Database
   {
+    friend class TaskStream;
+
   public:
-    Database(const std::string& connection_string);
-    ~Database() = default;
+    Database(const std::string& connection_string, const DatabaseConfig& config = DatabaseConfig());
+    ~Database();
 
     int create_task(const Task& task);
+    std::vector< int > create_tasks(const std::vector< Task >& tasks);
     std::vector< Task > get_all_tasks();
+    TaskPage get_tasks(const TaskQuery& query);
+    std::unique_ptr< TaskStream > stream_tasks(const std::optional< std::string >& status, size_t batch_size);
     std::optional< Task > get_task_by_id(int id);
-    void update_task(const Task& task);
+    int update_task(const Task& task);
+    int update_task(const Task& task, const std::vector< int >& expected_versions);
     void delete_task(int id);
 
     void initialize_database();
 
+    std::string get_change_tag() const;
+    std::optional< int > peek_task_version(int id) const;
+
+    PoolStats get_pool_stats() const;
+    CacheStats get_cache_stats() const;
+    GroupCommitStats get_group_commit_stats() const;
+
+    static constexpr const char* invalidation_channel = "tasks_changed";
+
   private:
     std::string connection_string_;
-    std::unique_ptr< pqxx::connection > connection_;
-    std::mutex db_mutex_;
+    ConnectionPool pool_;
+    std::unique_ptr< TaskCache > cache_;
+    std::unique_ptr< GroupCommitter > group_committer_;
+    std::jthread invalidation_listener_;
+    uint64_t instance_id_;
+    std::atomic< uint64_t > change_counter_;
+    size_t max_streams_;
+    std::atomic< size_t > active_streams_;
+
+    std::vector< int > insert_tasks(const std::vector< Task >& tasks);
+
+    void record_change();
+    void listen_for_invalidations(std::stop_token stop_token);
 
-    Task row_to_task(const pqxx::row& row) const;
-    bool check_id_exists(int id) const;
+    static void prepare_statements(pqxx::connection& connection);
+    static Task row_to_task(const pqxx::row& row);
   };
 }
 
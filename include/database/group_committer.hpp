@@ -0,0 +1,68 @@
+#ifndef GROUP_COMMITTER_HPP
+#define GROUP_COMMITTER_HPP
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "task.hpp"
+
+namespace database
+{
+  struct GroupCommitConfig
+  {
+    bool enabled = false;
+    std::chrono::microseconds window = std::chrono::microseconds(1000);
+    size_t max_batch_size = 64;
+  };
+
+  struct GroupCommitStats
+  {
+    static constexpr std::array< size_t, 8 > bucket_bounds = { 1, 2, 4, 8, 16, 32, 64, 128 };
+
+    uint64_t batches = 0;
+    uint64_t tasks = 0;
+    uint64_t failed_batches = 0;
+    size_t largest_batch = 0;
+    std::array< uint64_t, bucket_bounds.size() + 1 > batch_sizes = {};
+  };
+
+  class GroupCommitter
+  {
+  public:
+    using Flush = std::function< std::vector< int >(const std::vector< Task >&) >;
+
+    GroupCommitter(const GroupCommitConfig& config, Flush flush);
+    ~GroupCommitter();
+
+    int submit(const Task& task);
+    GroupCommitStats get_stats() const;
+
+  private:
+    struct Pending
+    {
+      Task task;
+      std::promise< int > id;
+    };
+
+    GroupCommitConfig config_;
+    Flush flush_;
+
+    mutable std::mutex queue_mutex_;
+    std::condition_variable_any queue_changed_;
+    std::vector< Pending > queue_;
+    GroupCommitStats stats_;
+
+    std::jthread flusher_;
+
+    void run(std::stop_token stop_token);
+    void record_batch(size_t size, bool failed);
+  };
+}
+
+#endif
@@ -0,0 +1,86 @@
+#ifndef TASK_HPP
+#define TASK_HPP
+
+#include <nlohmann/json.hpp>
+#include <chrono>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace nlohmann
+{
+  template<>
+  struct adl_serializer< std::chrono::system_clock::time_point >
+  {
+    static void to_json(json& j, const std::chrono::system_clock::time_point& tp)
+    {
+      auto seconds = std::chrono::duration_cast< std::chrono::seconds >(tp.time_since_epoch()).count();
+      j = seconds;
+    }
+
+    static void from_json(const json& j, std::chrono::system_clock::time_point& tp)
+    {
+      auto seconds = j.get< long long >();
+      tp = std::chrono::system_clock::time_point(std::chrono::seconds(seconds));
+    }
+  };
+}
+
+namespace database
+{
+  class JsonFormatError: public std::runtime_error
+  {
+  public:
+    JsonFormatError();
+  };
+
+  class Task
+  {
+    friend void to_json(nlohmann::json& j, const Task& t);
+    friend void from_json(const nlohmann::json&, Task& t);
+    friend void append_json(std::string& buffer, const Task& task);
+    friend void parse_task(std::string_view json, Task& task);
+
+  public:
+    Task() = default;
+    Task(int id);
+    Task(int id, std::string title, std::string description, std::string status, std::chrono::system_clock::time_point created_at);
+    ~Task() = default;
+
+    std::optional< int > get_id() const;
+    std::optional< std::string > get_title() const;
+    std::optional< std::string > get_description() const;
+    std::optional< std::string > get_status() const;
+    std::chrono::system_clock::time_point get_created_at() const;
+    std::optional< int > get_version() const;
+
+    void set_id(const std::optional< int >& id);
+    void set_title(const std::optional< std::string >& title);
+    void set_description(const std::optional< std::string >& description);
+    void set_status(const std::optional< std::string >& status);
+    void set_version(const std::optional< int >& version);
+
+  private:
+    std::optional< int > id_;
+    std::optional< std::string > title_;
+    std::optional< std::string > description_;
+    std::optional< std::string > status_;
+    std::chrono::system_clock::time_point created_at_;
+    std::optional< int > version_;
+  };
+
+  void to_json(nlohmann::json& j, const Task& t);
+  void from_json(const nlohmann::json&, Task& t);
+
+  void parse_task(std::string_view json, Task& task);
+  std::chrono::system_clock::time_point parse_timestamp(const std::string& timestamp);
+
+  void append_json(std::string& buffer, const Task& task);
+  void append_json(std::string& buffer, const std::vector< Task >& tasks);
+  void append_json_string(std::string& buffer, std::string_view value);
+  void append_timestamp(std::string& buffer, std::chrono::system_clock::time_point time_point);
+}
+
+#endif
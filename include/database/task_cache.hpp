@@ -0,0 +1,60 @@
+#ifndef TASK_CACHE_HPP
+#define TASK_CACHE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+#include "task.hpp"
+
+namespace database
+{
+  struct CacheStats
+  {
+    size_t size = 0;
+    size_t capacity = 0;
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+    uint64_t invalidations = 0;
+  };
+
+  class TaskCache
+  {
+  public:
+    TaskCache(size_t capacity, size_t shards_num);
+    ~TaskCache() = default;
+
+    std::optional< Task > get(int id);
+    uint64_t get_epoch(int id);
+    void put(int id, const Task& task, uint64_t epoch);
+    void invalidate(int id);
+    void clear();
+
+    CacheStats get_stats() const;
+
+  private:
+    struct Shard
+    {
+      mutable std::mutex mutex;
+      std::list< std::pair< int, Task > > entries;
+      std::unordered_map< int, std::list< std::pair< int, Task > >::iterator > index;
+      uint64_t epoch = 0;
+    };
+
+    std::vector< Shard > shards_;
+    size_t shard_capacity_;
+
+    std::atomic< uint64_t > hits_;
+    std::atomic< uint64_t > misses_;
+    std::atomic< uint64_t > evictions_;
+    std::atomic< uint64_t > invalidations_;
+
+    Shard& shard_for(int id);
+  };
+}
+
+#endif
@@ -0,0 +1,22 @@
+#ifndef GET_METRICS_HANDLER_HPP
+#define GET_METRICS_HANDLER_HPP
+
+#include "admission_controller.hpp"
+#include "request_handler.hpp"
+
+namespace handlers
+{
+  class GetMetricsHandler: public RequestHandler
+  {
+  public:
+    explicit GetMetricsHandler(std::shared_ptr< const server::AdmissionController > admission);
+
+    http::response< http::string_body > handle_request(const http::request< http::string_body >& req,
+      const RouteParams& params, const std::shared_ptr< database::Database >& db) const override;
+
+  private:
+    std::shared_ptr< const server::AdmissionController > admission_;
+  };
+}
+
+#endif
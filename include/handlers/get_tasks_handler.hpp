@@ -5,13 +5,33 @@
 
 namespace handlers
 {
+  class TaskListStream: public ResponseStream
+  {
+  public:
+    TaskListStream(http::response< http::empty_body > header, std::unique_ptr< database::TaskStream > tasks);
+
+    bool next_chunk(std::string& buffer) override;
+
+    static constexpr size_t batch_size = 256;
+
+  private:
+    std::unique_ptr< database::TaskStream > tasks_;
+    bool started_;
+    size_t written_;
+  };
+
   class GetTasksHandler: public RequestHandler
   {
   public:
-    bool can_handle(const http::request< http::string_body >& req) const override;
     http::response< http::string_body > handle_request(const http::request< http::string_body >& req,
-    std::shared_ptr< database::Database > db) override;
-    std::unique_ptr< RequestHandler > create() const override;
+      const RouteParams& params, const std::shared_ptr< database::Database >& db) const override;
+    std::unique_ptr< ResponseStream > open_stream(const http::request< http::string_body >& req,
+      const RouteParams& params, const std::shared_ptr< database::Database >& db) const override;
+
+    static constexpr size_t default_limit = 100;
+    static constexpr size_t max_limit = 1000;
+    static constexpr const char* next_cursor_header = "X-Next-Cursor";
+    static constexpr std::chrono::seconds stream_retry_after = std::chrono::seconds(1);
   };
 }
 
@@ -8,10 +8,10 @@ namespace handlers
   class PostTaskHandler: public RequestHandler
   {
   public:
-    bool can_handle(const http::request< http::string_body >& req) const override;
     http::response< http::string_body > handle_request(const http::request< http::string_body >& req,
-    std::shared_ptr< database::Database > db) override;
-    std::unique_ptr< RequestHandler > create() const override;
+      const RouteParams& params, const std::shared_ptr< database::Database >& db) const override;
+
+    static std::optional< std::string > validate(const database::Task& task);
   };
 }
 
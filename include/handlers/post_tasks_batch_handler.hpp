@@ -0,0 +1,18 @@
+#ifndef POST_TASKS_BATCH_HANDLER_HPP
+#define POST_TASKS_BATCH_HANDLER_HPP
+
+#include "request_handler.hpp"
+
+namespace handlers
+{
+  class PostTasksBatchHandler: public RequestHandler
+  {
+  public:
+    http::response< http::string_body > handle_request(const http::request< http::string_body >& req,
+      const RouteParams& params, const std::shared_ptr< database::Database >& db) const override;
+
+    static constexpr size_t max_batch_size = 10000;
+  };
+}
+
+#endif
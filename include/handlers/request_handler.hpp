@@ -3,6 +3,8 @@
 
 #include <boost/beast/http.hpp>
 #include "database.hpp"
+#include "response_stream.hpp"
+#include "route_params.hpp"
 
 namespace beast = boost::beast;
 namespace http = beast::http;
@@ -14,10 +16,13 @@ namespace handlers
   public:
     virtual ~RequestHandler() = default;
 
-    virtual bool can_handle(const http::request< http::string_body >& req) const = 0;
     virtual http::response< http::string_body > handle_request(const http::request< http::string_body >& req,
-    std::shared_ptr< database::Database > db) = 0;
-    virtual std::unique_ptr< RequestHandler > create() const = 0;
+      const RouteParams& params, const std::shared_ptr< database::Database >& db) const = 0;
+    virtual std::unique_ptr< ResponseStream > open_stream(const http::request< http::string_body >&, const RouteParams&,
+      const std::shared_ptr< database::Database >&) const
+    {
+      return nullptr;
+    }
   };
 }
 
@@ -0,0 +1,41 @@
+#ifndef RESPONSE_STREAM_HPP
+#define RESPONSE_STREAM_HPP
+
+#include <boost/beast/http.hpp>
+#include <memory>
+#include <string>
+#include "compression.hpp"
+
+namespace beast = boost::beast;
+namespace http = beast::http;
+
+namespace handlers
+{
+  class ResponseStream
+  {
+  public:
+    explicit ResponseStream(http::response< http::empty_body > header);
+    virtual ~ResponseStream() = default;
+
+    http::response< http::empty_body >& get_header();
+    virtual bool next_chunk(std::string& buffer) = 0;
+
+  private:
+    http::response< http::empty_body > header_;
+  };
+
+  class CompressedResponseStream: public ResponseStream
+  {
+  public:
+    CompressedResponseStream(std::unique_ptr< ResponseStream > stream, utils::ContentEncoding encoding, int level);
+
+    bool next_chunk(std::string& buffer) override;
+
+  private:
+    std::unique_ptr< ResponseStream > stream_;
+    utils::Compressor compressor_;
+    std::string raw_buffer_;
+  };
+}
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef ROUTE_PARAMS_HPP
+#define ROUTE_PARAMS_HPP
+
+#include <boost/beast/core/string.hpp>
+#include <array>
+#include <optional>
+#include <utility>
+
+namespace beast = boost::beast;
+
+namespace handlers
+{
+  class RouteParams
+  {
+  public:
+    RouteParams();
+
+    bool add(beast::string_view name, beast::string_view value);
+    std::optional< beast::string_view > get(beast::string_view name) const;
+    std::optional< int > get_int(beast::string_view name) const;
+    size_t size() const;
+
+    static constexpr size_t max_params = 4;
+
+  private:
+    std::array< std::pair< beast::string_view, beast::string_view >, max_params > params_;
+    size_t size_;
+  };
+}
+
+#endif
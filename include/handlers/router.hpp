@@ -0,0 +1,61 @@
+#ifndef ROUTER_HPP
+#define ROUTER_HPP
+
+#include <array>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+#include "request_handler.hpp"
+
+namespace handlers
+{
+  class Router
+  {
+  public:
+    struct Match
+    {
+      const RequestHandler* handler = nullptr;
+      size_t route = 0;
+      RouteParams params;
+    };
+
+    Router();
+    ~Router() = default;
+    Router(Router&&) = default;
+    Router& operator=(Router&&) = default;
+
+    void add(http::verb method, beast::string_view pattern, std::unique_ptr< RequestHandler > handler);
+    std::optional< Match > match(http::verb method, beast::string_view target) const;
+    std::vector< std::pair< http::verb, std::string > > get_routes() const;
+    std::string_view get_pattern(size_t route) const;
+
+    static Router create_default();
+
+    static constexpr size_t max_segments = 8;
+
+  private:
+    struct Node
+    {
+      std::vector< std::pair< std::string, std::unique_ptr< Node > > > children;
+      std::unique_ptr< Node > param_child;
+      std::string param_name;
+      std::vector< std::pair< http::verb, size_t > > handlers;
+    };
+
+    struct Route
+    {
+      http::verb method;
+      std::string pattern;
+      std::unique_ptr< RequestHandler > handler;
+    };
+
+    std::unique_ptr< Node > root_;
+    std::vector< Route > routes_;
+
+    static size_t split_path(beast::string_view target, std::array< beast::string_view, max_segments + 1 >& segments);
+  };
+}
+
+#endif
@@ -5,7 +5,17 @@
 #include <iostream>
 #include <format>
 #include <chrono>
-#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <thread>
+
+#ifndef LOGGER_MIN_LEVEL
+#define LOGGER_MIN_LEVEL 0
+#endif
 
 namespace logger
 {
@@ -18,23 +28,93 @@ namespace logger
     CRITICAL
   };
 
+  constexpr LogLevel compile_min_level = static_cast< LogLevel >(LOGGER_MIN_LEVEL);
+
+  std::optional< LogLevel > string_to_level(std::string_view level);
+
+  enum class OverflowPolicy
+  {
+    DROP,
+    BLOCK
+  };
+
   class Logger
   {
   public:
-    Logger() = default;
-    ~Logger() = default;
+    Logger();
+    ~Logger();
 
     static Logger& get_instance();
     void log(LogLevel level, const std::string& message);
+    void log(LogLevel level, std::string&& message);
+
+    template< class... Args >
+      requires (sizeof...(Args) > 0)
+    void log(LogLevel level, std::format_string< Args... > format, Args&&... args);
+
+    bool is_enabled(LogLevel level) const
+    {
+      return level >= min_level_.load(std::memory_order_relaxed);
+    }
+
+    void set_min_level(LogLevel level);
+    LogLevel get_min_level() const;
+    void flush();
+    void set_overflow_policy(OverflowPolicy policy);
+    uint64_t get_dropped() const;
+
+    static constexpr size_t buffer_capacity = 16384;
 
   private:
-    std::mutex log_mutex_;
+    struct alignas(64) Record
+    {
+      std::atomic< size_t > sequence;
+      LogLevel level;
+      std::chrono::system_clock::time_point time;
+      std::string message;
+    };
+
+    std::unique_ptr< Record[] > buffer_;
+    alignas(64) std::atomic< size_t > enqueue_pos_;
+    alignas(64) size_t dequeue_pos_;
+    std::atomic< uint64_t > published_;
+    std::atomic< uint64_t > written_;
+    std::atomic< uint64_t > dropped_;
+    std::atomic< OverflowPolicy > policy_;
+    std::atomic< LogLevel > min_level_;
+    std::atomic< bool > stopping_;
+    std::thread writer_;
+
+    void push(LogLevel level, std::string&& message);
+    bool try_push(LogLevel level, std::chrono::system_clock::time_point time, std::string& message);
+    void run();
+    uint64_t drain(std::string& batch);
 
     constexpr std::string_view level_to_string(LogLevel level);
   };
 }
 
-#define LOG(level, message) \
-  logger::Logger::get_instance().log(level, message);
+template< class... Args >
+  requires (sizeof...(Args) > 0)
+void logger::Logger::log(LogLevel level, std::format_string< Args... > format, Args&&... args)
+{
+  thread_local std::string buffer;
+  buffer.clear();
+  std::format_to(std::back_inserter(buffer), format, std::forward< Args >(args)...);
+  push(level, std::move(buffer));
+}
+
+#define LOG(level, ...) \
+  do \
+  { \
+    if constexpr ((level) >= logger::compile_min_level) \
+    { \
+      if (logger::Logger::get_instance().is_enabled(level)) \
+      { \
+        logger::Logger::get_instance().log(level, __VA_ARGS__); \
+      } \
+    } \
+  } \
+  while (false)
 
 #endif
@@ -0,0 +1,154 @@
+#ifndef METRICS_HPP
+#define METRICS_HPP
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace metrics
+{
+  constexpr size_t max_routes = 32;
+  constexpr size_t unmatched_route = max_routes;
+  constexpr size_t route_slots = max_routes + 1;
+  constexpr size_t status_classes = 5;
+
+  enum class DbOperation
+  {
+    CREATE_TASK,
+    CREATE_TASKS,
+    GET_ALL_TASKS,
+    GET_TASKS,
+    STREAM_TASKS,
+    FETCH_TASKS,
+    GET_TASK_BY_ID,
+    UPDATE_TASK,
+    DELETE_TASK
+  };
+
+  constexpr size_t db_operations = static_cast< size_t >(DbOperation::DELETE_TASK) + 1;
+
+  std::string_view operation_to_string(DbOperation operation);
+
+  struct RouteLabel
+  {
+    std::string method;
+    std::string pattern;
+  };
+
+  struct HistogramSnapshot;
+
+  class Histogram
+  {
+  public:
+    static constexpr uint64_t min_bound_us = 16;
+    static constexpr size_t octaves = 21;
+    static constexpr size_t sub_buckets = 8;
+    static constexpr size_t bucket_count = sub_buckets * octaves + 2;
+    static_assert(std::has_single_bit(sub_buckets) && sub_buckets <= min_bound_us);
+
+    static size_t bucket_index(std::chrono::nanoseconds value);
+    static double bucket_bound(size_t index);
+
+    void record(std::chrono::nanoseconds value);
+    void add_to(HistogramSnapshot& snapshot) const;
+
+  private:
+    std::array< std::atomic< uint64_t >, bucket_count > buckets_ = {};
+    std::atomic< uint64_t > sum_ = 0;
+  };
+
+  struct HistogramSnapshot
+  {
+    std::array< uint64_t, Histogram::bucket_count > buckets = {};
+    uint64_t count = 0;
+    std::chrono::nanoseconds sum = std::chrono::nanoseconds::zero();
+  };
+
+  struct Snapshot
+  {
+    std::vector< RouteLabel > routes;
+    std::array< std::array< uint64_t, status_classes >, route_slots > requests = {};
+    std::array< HistogramSnapshot, route_slots > request_latency;
+    std::array< HistogramSnapshot, db_operations > db_latency;
+    std::array< uint64_t, db_operations > db_errors = {};
+    uint64_t bytes_received = 0;
+    uint64_t bytes_sent = 0;
+    int64_t active_sessions = 0;
+  };
+
+  class Registry
+  {
+  public:
+    Registry() = default;
+    ~Registry() = default;
+
+    static Registry& get_instance();
+
+    void set_routes(std::vector< RouteLabel > routes);
+    void record_request(size_t route, unsigned status, std::chrono::nanoseconds latency);
+    void record_bytes_received(uint64_t bytes);
+    void record_bytes_sent(uint64_t bytes);
+    void session_opened();
+    void session_closed();
+    void record_db_query(DbOperation operation, std::chrono::nanoseconds latency, bool failed);
+
+    Snapshot collect() const;
+    void write_prometheus(std::string& out) const;
+
+  private:
+    struct alignas(64) ThreadCells
+    {
+      std::array< std::array< std::atomic< uint64_t >, status_classes >, route_slots > requests = {};
+      std::array< Histogram, route_slots > request_latency;
+      std::array< Histogram, db_operations > db_latency;
+      std::array< std::atomic< uint64_t >, db_operations > db_errors = {};
+      std::atomic< uint64_t > bytes_received = 0;
+      std::atomic< uint64_t > bytes_sent = 0;
+      std::atomic< uint64_t > sessions_opened = 0;
+      std::atomic< uint64_t > sessions_closed = 0;
+    };
+
+    class Lease
+    {
+    public:
+      explicit Lease(Registry& registry);
+      ~Lease();
+
+      ThreadCells& get();
+
+    private:
+      Registry& registry_;
+      ThreadCells* cells_;
+    };
+
+    mutable std::mutex mutex_;
+    std::vector< std::unique_ptr< ThreadCells > > cells_;
+    std::vector< ThreadCells* > free_cells_;
+    std::vector< RouteLabel > routes_;
+
+    ThreadCells& local();
+  };
+
+  class DbTimer
+  {
+  public:
+    explicit DbTimer(DbOperation operation);
+    DbTimer(const DbTimer&) = delete;
+    DbTimer& operator=(const DbTimer&) = delete;
+    ~DbTimer();
+
+  private:
+    DbOperation operation_;
+    std::chrono::steady_clock::time_point start_;
+    int exceptions_;
+  };
+}
+
+#endif
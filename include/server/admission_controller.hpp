@@ -0,0 +1,88 @@
+#ifndef ADMISSION_CONTROLLER_HPP
+#define ADMISSION_CONTROLLER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+
+namespace server
+{
+  struct AdmissionConfig
+  {
+    size_t max_sessions = 0;
+    size_t max_inflight = 0;
+    std::chrono::milliseconds target_delay = std::chrono::milliseconds(100);
+    std::chrono::milliseconds interval = std::chrono::milliseconds(1000);
+    std::chrono::seconds retry_after = std::chrono::seconds(1);
+  };
+
+  struct AdmissionStats
+  {
+    size_t sessions = 0;
+    size_t inflight = 0;
+    bool overloaded = false;
+    uint64_t rejected_sessions = 0;
+    uint64_t shed_inflight = 0;
+    uint64_t shed_queue_delay = 0;
+  };
+
+  class AdmissionController;
+
+  class AdmissionPermit
+  {
+  public:
+    enum class Kind
+    {
+      SESSION,
+      REQUEST
+    };
+
+    AdmissionPermit(AdmissionController& controller, Kind kind);
+    AdmissionPermit(AdmissionPermit&& other) noexcept;
+    AdmissionPermit(const AdmissionPermit&) = delete;
+    AdmissionPermit& operator=(const AdmissionPermit&) = delete;
+    AdmissionPermit& operator=(AdmissionPermit&&) = delete;
+    ~AdmissionPermit();
+
+    bool start();
+
+  private:
+    AdmissionController* controller_;
+    Kind kind_;
+    std::chrono::steady_clock::time_point created_;
+  };
+
+  class AdmissionController
+  {
+    friend class AdmissionPermit;
+
+  public:
+    explicit AdmissionController(const AdmissionConfig& config);
+
+    std::optional< AdmissionPermit > try_open_session();
+    std::optional< AdmissionPermit > try_admit_request();
+    AdmissionStats get_stats() const;
+    std::chrono::seconds get_retry_after() const;
+
+  private:
+    AdmissionConfig config_;
+
+    std::atomic< size_t > sessions_;
+    std::atomic< size_t > inflight_;
+    std::atomic< uint64_t > rejected_sessions_;
+    std::atomic< uint64_t > shed_inflight_;
+    std::atomic< uint64_t > shed_queue_delay_;
+
+    mutable std::mutex delay_mutex_;
+    std::chrono::nanoseconds min_delay_;
+    std::chrono::steady_clock::time_point interval_end_;
+    bool overloaded_;
+
+    bool check_queue_delay(std::chrono::steady_clock::time_point enqueued);
+    void release(AdmissionPermit::Kind kind);
+  };
+}
+
+#endif
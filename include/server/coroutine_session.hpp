@@ -0,0 +1,49 @@
+#ifndef COROUTINE_SESSION_HPP
+#define COROUTINE_SESSION_HPP
+
+#include <boost/asio/awaitable.hpp>
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/asio/redirect_error.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include "server.hpp"
+
+namespace server
+{
+  class CoroutineSession: public std::enable_shared_from_this< CoroutineSession >
+  {
+  public:
+    CoroutineSession(tcp::socket&& socket, std::shared_ptr< const SessionContext > context, AdmissionPermit permit);
+    ~CoroutineSession();
+
+    void run();
+    void do_close();
+
+  private:
+    beast::tcp_stream stream_;
+    beast::flat_buffer buffer_;
+    std::string spare_body_;
+    std::shared_ptr< const SessionContext > context_;
+    AdmissionPermit permit_;
+    std::deque< Exchange > exchanges_;
+    net::steady_timer read_signal_;
+    net::steady_timer write_signal_;
+    bool read_stopped_;
+    bool closed_;
+    bool linger_;
+
+    net::awaitable< void > read_loop(std::shared_ptr< CoroutineSession > self);
+    net::awaitable< void > write_loop(std::shared_ptr< CoroutineSession > self);
+    void dispatch_requests();
+    net::awaitable< void > handle_request(std::shared_ptr< CoroutineSession > self, Exchange* exchange);
+    net::awaitable< void > process(Exchange* exchange);
+    net::awaitable< bool > write_response(Exchange& exchange);
+    net::awaitable< bool > write_stream(Exchange& exchange);
+    net::awaitable< bool > fetch_next_chunk(Exchange* exchange, std::string* chunk);
+    net::awaitable< void > wait(net::steady_timer& signal);
+    void reject_request(http::request< http::string_body > req, http::status status, const std::string& message);
+  };
+}
+
+#endif
@@ -3,15 +3,25 @@
 
 #include <boost/beast/core.hpp>
 #include <boost/beast/http.hpp>
+#include <boost/asio/any_io_executor.hpp>
 #include <boost/asio/dispatch.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <boost/asio/strand.hpp>
+#include <boost/asio/thread_pool.hpp>
+#include <array>
+#include <deque>
 #include <memory>
 #include <expected>
 #include <thread>
+#include "admission_controller.hpp"
+#include "compression.hpp"
 #include "database.hpp"
-#include "handler_factory.hpp"
 #include "http_utils.hpp"
 #include "logger.hpp"
+#include "metrics.hpp"
+#include "router.hpp"
+#include "tracing.hpp"
 
 namespace beast = boost::beast;         // from <boost/beast.hpp>
 namespace http = beast::http;           // from <boost/beast/http.hpp>
@@ -20,66 +30,208 @@ using tcp = boost::asio::ip::tcp;       // from <boost/asio/ip/tcp.hpp>
 
 namespace server
 {
+  enum class SessionMode
+  {
+    CALLBACK,
+    COROUTINE
+  };
+
+  struct ServerConfig
+  {
+    size_t db_threads_num = 4;
+    uint32_t header_limit = 8 * 1024;
+    uint64_t body_limit = 8 * 1024 * 1024;
+    size_t pipeline_limit = 16;
+    utils::CompressionConfig compression;
+    bool reuse_port = false;
+    SessionMode session_mode = SessionMode::CALLBACK;
+    AdmissionConfig admission;
+    bool metrics = true;
+    tracing::TracingConfig tracing;
+  };
+
+  struct SessionContext
+  {
+    std::shared_ptr< database::Database > db;
+    net::any_io_executor db_executor;
+    std::shared_ptr< const handlers::Router > router;
+    uint32_t header_limit = 8 * 1024;
+    uint64_t body_limit = 8 * 1024 * 1024;
+    size_t pipeline_limit = 16;
+    utils::CompressionConfig compression;
+    SessionMode session_mode = SessionMode::CALLBACK;
+    std::shared_ptr< AdmissionController > admission;
+    std::shared_ptr< tracing::Tracer > tracer;
+  };
+
+  struct Exchange
+  {
+    http::request< http::string_body > req;
+    std::optional< handlers::Router::Match > route;
+    http::response< http::string_body > res;
+    std::unique_ptr< handlers::ResponseStream > response_stream;
+    std::optional< AdmissionPermit > permit;
+    std::chrono::steady_clock::time_point started;
+    std::unique_ptr< tracing::Trace > trace;
+    bool dispatched = false;
+    bool ready = false;
+  };
+
+  bool is_safe_method(http::verb method);
+
+  // Hands queued exchanges to dispatch in request order. GET/HEAD run concurrently with each other; any other method
+  // waits until every earlier exchange is handled, and holds back everything after it until it is handled itself.
+  template< typename Dispatch >
+  void dispatch_exchanges(std::deque< Exchange >& exchanges, Dispatch dispatch)
+  {
+    bool handling = false;
+    bool handling_unsafe = false;
+    for (Exchange& exchange : exchanges)
+    {
+      if (exchange.ready)
+      {
+        continue;
+      }
+
+      bool safe = is_safe_method(exchange.req.method());
+      if (!exchange.dispatched)
+      {
+        if (handling_unsafe || (!safe && handling))
+        {
+          return;
+        }
+        exchange.dispatched = true;
+        dispatch(exchange);
+      }
+      handling = true;
+      handling_unsafe = handling_unsafe || !safe;
+    }
+  }
+
+  bool admit_exchange(Exchange& exchange, const SessionContext& context);
+  void process_exchange(Exchange& exchange, const SessionContext& context);
+  void begin_exchange(Exchange& exchange, const SessionContext& context, std::chrono::steady_clock::time_point read_started);
+  void begin_write(Exchange& exchange);
+  void record_exchange(Exchange& exchange, const SessionContext& context);
+  void log_connection(std::string_view context, const http::request< http::string_body >& req);
+  void log_connection_error(std::string_view context, std::string_view error, const http::request< http::string_body >& req);
+  void log_connection_error(std::string_view context, boost::beast::error_code ec, const http::request< http::string_body >& req);
+
+  // Closes a connection whose request was not read in full: shuts down the send side and drains the input until EOF
+  // or timeout, so the final response isn't lost to a reset caused by unread data
+  class LingeringClose: public std::enable_shared_from_this< LingeringClose >
+  {
+  public:
+    explicit LingeringClose(tcp::socket&& socket);
+
+    void run();
+
+    static constexpr std::chrono::seconds timeout = std::chrono::seconds(2);
+
+  private:
+    tcp::socket socket_;
+    net::steady_timer timer_;
+    std::array< char, 4096 > buffer_;
+
+    void do_read();
+    void on_read(beast::error_code ec, std::size_t bytes_transferred);
+    void on_timeout(beast::error_code ec);
+  };
+
   class Session: public std::enable_shared_from_this< Session >
   {
   public:
-    Session(tcp::socket&& socket, std::shared_ptr< database::Database > db);
+    Session(tcp::socket&& socket, std::shared_ptr< const SessionContext > context, AdmissionPermit permit);
+    ~Session();
 
     void run();
     void do_read();
+    void on_read_header(beast::error_code ec, std::size_t bytes_transferred);
+    void on_write_continue(beast::error_code ec, std::size_t bytes_transferred);
+    void do_read_body();
     void on_read(beast::error_code ec, std::size_t bytes_transferred);
-    void send_response(http::message_generator&& msg);
-    void on_write(bool keep_alive, beast::error_code ec, std::size_t bytes_transferred);
+    void do_write();
     void do_close();
 
+    static constexpr std::string_view continue_response = "HTTP/1.1 100 Continue\r\n\r\n";
+
   private:
     beast::tcp_stream stream_;
     beast::flat_buffer buffer_;
+    std::optional< http::request_parser< http::string_body > > parser_;
     http::request< http::string_body > req_;
-    std::shared_ptr< database::Database > db_;
+    std::string spare_body_;
+    std::shared_ptr< const SessionContext > context_;
+    AdmissionPermit permit_;
+    std::deque< Exchange > exchanges_;
+    bool reading_;
+    bool writing_;
+    bool read_stopped_;
+    bool closed_;
+    bool linger_;
+    bool continue_pending_;
+    std::optional< http::response_serializer< http::empty_body > > stream_serializer_;
+    std::string chunk_buffer_;
+    std::chrono::steady_clock::time_point read_started_;
 
-    void log_connection(const std::string& context);
-    void log_connection_error(const std::string& context, const std::string& error);
-    void log_connection_error(const std::string& context, boost::beast::error_code ec);
+    void write_continue();
+    void dispatch_requests();
+    void handle_request(Exchange* exchange);
+    void on_handled(Exchange* exchange);
+    void send_stream(Exchange& exchange);
+    void fetch_next_chunk(Exchange* exchange);
+    void write_chunk(Exchange* exchange, bool has_more, bool failed);
+    void on_write_stream(Exchange* exchange, beast::error_code ec, std::size_t bytes_transferred);
+    void on_write(bool keep_alive, beast::error_code ec, std::size_t bytes_transferred);
+    void maybe_read();
+    void reject_request(http::status status, const std::string& message);
   };
 
   class Listener: public std::enable_shared_from_this< Listener >
   {
   public:
-    Listener(net::io_context& ioc, std::shared_ptr< database::Database > db);
+    Listener(net::io_context& ioc, std::shared_ptr< const SessionContext > context);
     static std::expected< std::shared_ptr< Listener >, std::string > create(net::io_context& ioc, tcp::endpoint endpoint,
-      std::shared_ptr< database::Database > db);
+      std::shared_ptr< const SessionContext > context, bool reuse_port = false);
 
     void run();
 
   private:
     net::io_context& ioc_;
     tcp::acceptor acceptor_;
-    std::shared_ptr< database::Database > db_;
+    std::shared_ptr< const SessionContext > context_;
+    std::string overloaded_response_;
 
     void do_accept();
     void on_accept(beast::error_code ec, tcp::socket socket);
+    void on_reject(std::shared_ptr< tcp::socket > socket, beast::error_code ec, std::size_t bytes_transferred);
   };
 
+  // Single-use: stop() joins the database thread pool, so a stopped server can't be started again
   class Server
   {
   public:
-    Server(const std::string& host, unsigned short port, size_t threads_num, std::shared_ptr< database::Database > db);
+    Server(const std::string& host, unsigned short port, size_t threads_num, std::shared_ptr< database::Database > db,
+      const ServerConfig& config = ServerConfig());
     ~Server();
 
     void start();
     void stop();
+    AdmissionStats get_admission_stats() const;
 
   private:
     std::string host_;
     unsigned short port_;
     size_t threads_num_;
     bool running_;
+    bool stopped_;
 
-    net::io_context ioc_;
-    std::shared_ptr< Listener > listener_;
+    std::vector< std::unique_ptr< net::io_context > > io_contexts_;
+    net::thread_pool db_pool_;
+    std::vector< std::shared_ptr< Listener > > listeners_;
     std::vector< std::jthread > thread_pool_;
     std::shared_ptr< database::Database > db_;
+    std::shared_ptr< AdmissionController > admission_;
   };
 }
 
@@ -0,0 +1,151 @@
+#ifndef TRACING_HPP
+#define TRACING_HPP
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+namespace tracing
+{
+  enum class Phase
+  {
+    READ,
+    ROUTE,
+    QUEUE,
+    HANDLER,
+    PARSE,
+    DATABASE,
+    SERIALIZE,
+    COMPRESS,
+    WRITE
+  };
+
+  constexpr size_t phase_count = static_cast< size_t >(Phase::WRITE) + 1;
+
+  std::string_view phase_to_string(Phase phase);
+
+  struct TracingConfig
+  {
+    bool server_timing = false;
+    double sample_ratio = 0.0;
+    std::string output_path;
+  };
+
+  class Trace
+  {
+  public:
+    Trace(bool sampled, bool server_timing);
+
+    void begin(Phase phase);
+    void end(Phase phase);
+    void add(Phase phase, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end);
+
+    bool is_sampled() const;
+    bool has_server_timing() const;
+    std::string get_server_timing() const;
+
+  private:
+    friend class Tracer;
+
+    struct PhaseRecord
+    {
+      std::chrono::steady_clock::time_point start;
+      std::chrono::nanoseconds duration = std::chrono::nanoseconds::zero();
+      bool recorded = false;
+    };
+
+    bool sampled_;
+    bool server_timing_;
+    uint64_t trace_id_high_;
+    uint64_t trace_id_low_;
+    uint64_t parent_span_id_;
+    std::chrono::steady_clock::time_point start_;
+    std::chrono::system_clock::time_point wall_start_;
+    std::array< PhaseRecord, phase_count > phases_;
+  };
+
+  class Tracer
+  {
+  public:
+    explicit Tracer(const TracingConfig& config);
+    ~Tracer();
+
+    bool is_enabled() const
+    {
+      return enabled_;
+    }
+
+    std::unique_ptr< Trace > start(std::string_view traceparent);
+    void finish(const Trace& trace, std::string_view method, std::string_view route, unsigned status);
+
+  private:
+    TracingConfig config_;
+    bool enabled_;
+    std::mutex output_mutex_;
+    std::ofstream output_;
+  };
+
+  inline thread_local Trace* current_trace = nullptr;
+
+  class ActiveTrace
+  {
+  public:
+    explicit ActiveTrace(Trace* trace):
+      previous_(current_trace)
+    {
+      current_trace = trace;
+    }
+
+    ActiveTrace(const ActiveTrace&) = delete;
+    ActiveTrace& operator=(const ActiveTrace&) = delete;
+
+    ~ActiveTrace()
+    {
+      current_trace = previous_;
+    }
+
+  private:
+    Trace* previous_;
+  };
+
+  class PhaseTimer
+  {
+  public:
+    explicit PhaseTimer(Phase phase):
+      PhaseTimer(current_trace, phase)
+    {}
+
+    PhaseTimer(Trace* trace, Phase phase):
+      trace_(trace),
+      phase_(phase)
+    {
+      if (trace_)
+      {
+        start_ = std::chrono::steady_clock::now();
+      }
+    }
+
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+
+    ~PhaseTimer()
+    {
+      if (trace_)
+      {
+        trace_->add(phase_, start_, std::chrono::steady_clock::now());
+      }
+    }
+
+  private:
+    Trace* trace_;
+    Phase phase_;
+    std::chrono::steady_clock::time_point start_;
+  };
+}
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef COMPRESSION_HPP
+#define COMPRESSION_HPP
+
+#include <boost/beast/http.hpp>
+#include <zlib.h>
+#include <string>
+#include <string_view>
+
+namespace beast = boost::beast;
+namespace http = beast::http;
+
+namespace utils
+{
+  enum class ContentEncoding
+  {
+    IDENTITY,
+    GZIP,
+    DEFLATE
+  };
+
+  struct CompressionConfig
+  {
+    bool enabled = true;
+    size_t threshold = 1024;
+    int level = 6;
+  };
+
+  class Compressor
+  {
+  public:
+    Compressor(ContentEncoding encoding, int level);
+    ~Compressor();
+    Compressor(const Compressor&) = delete;
+    Compressor& operator=(const Compressor&) = delete;
+
+    void compress(std::string_view input, std::string& output, bool finish);
+
+  private:
+    z_stream stream_;
+  };
+
+  ContentEncoding negotiate_encoding(beast::string_view accept_encoding);
+
+  const char* encoding_to_string(ContentEncoding encoding);
+
+  std::string compress(std::string_view input, ContentEncoding encoding, int level);
+
+  // "5" becomes "5-gzip": a compressed body is a different representation and needs its own strong tag
+  std::string encode_etag(beast::string_view etag, ContentEncoding encoding);
+
+  bool compress_response(http::response< http::string_body >& res, beast::string_view accept_encoding,
+    const CompressionConfig& config);
+}
+
+#endif
@@ -4,6 +4,8 @@
 #include <boost/beast/http.hpp>
 #include <boost/algorithm/string.hpp>
 #include <nlohmann/json.hpp>
+#include <chrono>
+#include <unordered_map>
 #include "logger.hpp"
 
 namespace beast = boost::beast;
@@ -15,8 +17,24 @@ namespace utils
 
   http::response< http::string_body > create_json_response(http::status status, const nlohmann::json& json);
 
+  http::response< http::string_body > create_raw_json_response(http::status status, std::string body);
+
+  http::response< http::string_body > create_not_modified_response(const std::string& etag);
+
+  http::response< http::string_body > create_unavailable_response(std::chrono::seconds retry_after);
+
   std::vector< std::string > parse_parameters(beast::string_view target);
 
+  std::unordered_map< std::string, std::string > parse_query(beast::string_view target);
+
+  std::string make_version_tag(int version);
+
+  std::optional< std::vector< int > > parse_if_match(beast::string_view if_match);
+
+  std::string make_etag(std::string_view value);
+
+  bool match_etag(beast::string_view if_none_match, beast::string_view etag);
+
   enum class TaskStatus
   {
     TODO,
@@ -0,0 +1,219 @@
+#include "connection_pool.hpp"
+
+double database::PoolStats::utilization() const
+{
+  if (max_size == 0)
+  {
+    return 0.0;
+  }
+  return static_cast< double >(in_use) / static_cast< double >(max_size);
+}
+
+std::chrono::nanoseconds database::PoolStats::average_wait() const
+{
+  if (checkouts == 0)
+  {
+    return std::chrono::nanoseconds::zero();
+  }
+  return total_wait / checkouts;
+}
+
+database::PooledConnection::PooledConnection(ConnectionPool& pool, std::unique_ptr< pqxx::connection > connection,
+  uint64_t generation):
+  pool_(&pool),
+  connection_(std::move(connection)),
+  generation_(generation)
+{}
+
+database::PooledConnection::PooledConnection(PooledConnection&& other) noexcept:
+  pool_(other.pool_),
+  connection_(std::move(other.connection_)),
+  generation_(other.generation_)
+{
+  other.pool_ = nullptr;
+}
+
+database::PooledConnection::~PooledConnection()
+{
+  if (pool_ && connection_)
+  {
+    pool_->release(std::move(connection_), generation_);
+  }
+}
+
+pqxx::connection& database::PooledConnection::operator*() const
+{
+  return *connection_;
+}
+
+pqxx::connection* database::PooledConnection::operator->() const
+{
+  return connection_.get();
+}
+
+database::ConnectionPool::ConnectionPool(const std::string& connection_string, const PoolConfig& config):
+  connection_string_(connection_string),
+  config_(config),
+  idle_(),
+  size_(0),
+  waiting_(0),
+  initializer_(),
+  generation_(0),
+  checkouts_(0),
+  timeouts_(0),
+  reconnects_(0),
+  total_wait_(std::chrono::nanoseconds::zero()),
+  max_wait_(std::chrono::nanoseconds::zero())
+{
+  config_.max_size = std::max(static_cast< size_t >(1), config_.max_size);
+  config_.min_size = std::min(config_.min_size, config_.max_size);
+
+  idle_.reserve(config_.max_size);
+  for (size_t i = 0; i != config_.min_size; ++i)
+  {
+    idle_.push_back({ open_connection(), std::chrono::steady_clock::now(), 0 });
+    ++size_;
+  }
+}
+
+database::PooledConnection database::ConnectionPool::acquire()
+{
+  auto start = std::chrono::steady_clock::now();
+  auto deadline = start + config_.checkout_timeout;
+
+  std::unique_lock< std::mutex > lock(pool_mutex_);
+
+  ++waiting_;
+  while (idle_.empty() && size_ >= config_.max_size)
+  {
+    if (available_.wait_until(lock, deadline) == std::cv_status::timeout && idle_.empty() && size_ >= config_.max_size)
+    {
+      --waiting_;
+      ++timeouts_;
+      throw std::runtime_error("Timed out waiting for database connection");
+    }
+  }
+  --waiting_;
+
+  record_wait(std::chrono::steady_clock::now() - start);
+
+  IdleConnection idle;
+  if (!idle_.empty())
+  {
+    idle = std::move(idle_.back());
+    idle_.pop_back();
+  }
+  else
+  {
+    ++size_;
+  }
+  auto initializer = initializer_;
+  uint64_t generation = generation_;
+  lock.unlock();
+
+  std::unique_ptr< pqxx::connection > connection;
+  try
+  {
+    bool initialized = idle.connection && idle.generation == generation;
+    if (idle.connection)
+    {
+      connection = check_health(std::move(idle));
+    }
+    if (!connection)
+    {
+      connection = open_connection();
+      initialized = false;
+    }
+
+    if (initializer && !initialized)
+    {
+      (*initializer)(*connection);
+    }
+  }
+  catch (...)
+  {
+    lock.lock();
+    --size_;
+    available_.notify_one();
+    throw;
+  }
+
+  return PooledConnection(*this, std::move(connection), generation);
+}
+
+database::PoolStats database::ConnectionPool::get_stats() const
+{
+  std::lock_guard< std::mutex > lock(pool_mutex_);
+
+  PoolStats stats;
+  stats.size = size_;
+  stats.idle = idle_.size();
+  stats.in_use = size_ - idle_.size();
+  stats.max_size = config_.max_size;
+  stats.waiting = waiting_;
+  stats.checkouts = checkouts_;
+  stats.timeouts = timeouts_;
+  stats.reconnects = reconnects_;
+  stats.total_wait = total_wait_;
+  stats.max_wait = max_wait_;
+  return stats;
+}
+
+void database::ConnectionPool::set_initializer(ConnectionInitializer initializer)
+{
+  std::lock_guard< std::mutex > lock(pool_mutex_);
+  initializer_ = std::make_shared< const ConnectionInitializer >(std::move(initializer));
+  ++generation_;
+}
+
+std::unique_ptr< pqxx::connection > database::ConnectionPool::open_connection()
+{
+  return std::make_unique< pqxx::connection >(connection_string_);
+}
+
+std::unique_ptr< pqxx::connection > database::ConnectionPool::check_health(IdleConnection idle)
+{
+  if (idle.connection->is_open())
+  {
+    if (std::chrono::steady_clock::now() - idle.last_used < config_.health_check_interval)
+    {
+      return std::move(idle.connection);
+    }
+
+    try
+    {
+      pqxx::nontransaction txn(*idle.connection);
+      txn.exec("SELECT 1");
+      return std::move(idle.connection);
+    }
+    catch (const pqxx::failure&)
+    {}
+  }
+
+  std::lock_guard< std::mutex > lock(pool_mutex_);
+  ++reconnects_;
+  return nullptr;
+}
+
+void database::ConnectionPool::release(std::unique_ptr< pqxx::connection > connection, uint64_t generation)
+{
+  std::lock_guard< std::mutex > lock(pool_mutex_);
+
+  if (connection->is_open())
+  {
+    idle_.push_back({ std::move(connection), std::chrono::steady_clock::now(), generation });
+  }
+  else
+  {
+    --size_;
+  }
+
+  available_.notify_one();
+}
+
+void database::ConnectionPool::record_wait(std::chrono::nanoseconds wait)
+{
+  ++checkouts_;
+  total_wait_ += wait;
+  max_wait_ = std::max(max_wait_, wait);
+}
@@ -1,160 +1,269 @@
 #include "database.hpp"
-
-database::Task::Task(int id):
-  id_(id),
-  title_(),
-  description_(),
-  status_(),
-  created_at_(std::chrono::system_clock::now())
-{}
-
-database::Task::Task(int id, std::string title, std::string description, std::string status, 
-  std::chrono::system_clock::time_point created_at):
-  id_(id),
-  title_(title),
-  description_(description),
-  status_(status),
-  created_at_(created_at)
-{}
-
-std::optional< int > database::Task::get_id() const
+#include <algorithm>
+#include <charconv>
+#include <condition_variable>
+#include <random>
+#include "logger.hpp"
+#include "metrics.hpp"
+#include "tracing.hpp"
+
+std::string database::encode_cursor(const TaskCursor& cursor)
 {
-  return id_;
+  char buffer[64];
+  auto end = std::to_chars(buffer, buffer + sizeof(buffer), static_cast< unsigned long long >(cursor.created_at), 16).ptr;
+  *end++ = '.';
+  end = std::to_chars(end, buffer + sizeof(buffer), static_cast< unsigned int >(cursor.id), 16).ptr;
+  return std::string(buffer, end);
 }
 
-std::optional< std::string > database::Task::get_title() const
+std::optional< database::TaskCursor > database::decode_cursor(std::string_view cursor)
 {
-  return title_;
-}
+  auto separator = cursor.find('.');
+  if (separator == std::string_view::npos)
+  {
+    return std::nullopt;
+  }
 
-std::optional< std::string > database::Task::get_description() const
-{
-  return description_;
-}
+  unsigned long long created_at = 0;
+  unsigned int id = 0;
+  const char* first = cursor.data();
+  const char* middle = first + separator;
+  const char* last = first + cursor.size();
 
-std::optional< std::string > database::Task::get_status() const
-{
-  return status_;
-}
+  auto created_at_result = std::from_chars(first, middle, created_at, 16);
+  auto id_result = std::from_chars(middle + 1, last, id, 16);
+  if (created_at_result.ec != std::errc() || created_at_result.ptr != middle ||
+    id_result.ec != std::errc() || id_result.ptr != last)
+  {
+    return std::nullopt;
+  }
 
-std::chrono::system_clock::time_point database::Task::get_created_at() const
-{
-  return created_at_;
+  return TaskCursor{ static_cast< long long >(created_at), static_cast< int >(id) };
 }
 
-void database::Task::set_id(const std::optional< int >& id)
+namespace
 {
-  id_ = id;
-}
+  // One pooled connection always stays free for ordinary requests, so a single-connection pool doesn't stream at all
+  size_t get_stream_limit(const database::DatabaseConfig& config)
+  {
+    size_t available = config.pool.max_size > 0 ? config.pool.max_size - 1 : 0;
+    size_t requested = config.max_streams != 0 ? config.max_streams : std::max(static_cast< size_t >(1), config.pool.max_size / 2);
+    return std::min(requested, available);
+  }
 
-void database::Task::set_title(const std::optional< std::string >& title)
-{
-  title_ = title;
-}
+  std::vector< int > result_to_ids(const pqxx::result& result, size_t size, int first_position)
+  {
+    std::vector< int > ids(size);
+    for (size_t i = 0; i != result.size(); ++i)
+    {
+      ids.at(result[i][0].as< int >() - first_position) = result[i][1].as< int >();
+    }
+    return ids;
+  }
 
-void database::Task::set_description(const std::optional< std::string >& description)
-{
-  description_ = description;
+  std::string join_versions(const std::vector< int >& versions)
+  {
+    std::string joined;
+    for (int version : versions)
+    {
+      if (!joined.empty())
+      {
+        joined += " or ";
+      }
+      joined += std::to_string(version);
+    }
+    return joined;
+  }
 }
 
-void database::Task::set_status(const std::optional< std::string >& status)
+database::TaskNotFoundError::TaskNotFoundError(int id):
+  std::runtime_error("Task with id " + std::to_string(id) + " does not exist")
+{}
+
+database::VersionConflictError::VersionConflictError(int id, const std::vector< int >& expected_versions):
+  std::runtime_error("Task with id " + std::to_string(id) + " is not at version " + join_versions(expected_versions))
+{}
+
+database::TaskStream::TaskStream(PooledConnection connection, std::atomic< size_t >& active_streams,
+  const std::optional< std::string >& status, size_t batch_size):
+  connection_(std::move(connection)),
+  active_streams_(active_streams),
+  txn_(*connection_),
+  batch_size_(std::max(static_cast< size_t >(1), batch_size)),
+  prefetched_(),
+  finished_(false)
 {
-  status_ = status;
+  std::string filter = status ? "WHERE lower(status) = lower(" + txn_.quote(status.value()) + ") " : "";
+
+  pqxx::pipeline pipeline(txn_);
+  auto declare = pipeline.insert(
+    "DECLARE tasks_stream NO SCROLL CURSOR FOR "
+    "SELECT id, title, description, status, created_at, version FROM tasks " + filter +
+    "ORDER BY created_at DESC, id DESC"
+  );
+  auto first_batch = pipeline.insert(fetch_query());
+  pipeline.complete();
+
+  pipeline.retrieve(declare);
+  prefetched_ = pipeline.retrieve(first_batch);
 }
 
-void database::to_json(nlohmann::json& j, const Task& t)
+database::TaskStream::~TaskStream()
 {
-  auto time_t = std::chrono::system_clock::to_time_t(t.created_at_);
-  std::tm tm = *std::gmtime(&time_t);
-  std::ostringstream oss;
-  oss << std::put_time(&tm, "%Y-%m-%d %H:%M:%S");
-
-  j = nlohmann::json{
-    { "id", t.id_.value() },
-    { "title", t.title_.value() },
-    { "description", t.description_.value() },
-    { "status", t.status_.value() },
-    { "created_at", oss.str() }
-  };
+  active_streams_.fetch_sub(1, std::memory_order_release);
 }
 
-void database::from_json(const nlohmann::json& j, Task& t)
+std::vector< database::Task > database::TaskStream::fetch()
 {
-  if (j.contains("id") && !j["id"].is_null())
-  {
-    t.id_ = j["id"].get< int >();
-  }
-  if (j.contains("title") && !j["title"].is_null())
-  {
-    t.title_ = j["title"].get< std::string >();
-  }
-  if (j.contains("description") && !j["description"].is_null())
-  {
-    t.description_ = j["description"].get< std::string >();
-  }
-  if (j.contains("status") && !j["status"].is_null())
+  metrics::DbTimer timer(metrics::DbOperation::FETCH_TASKS);
+  tracing::PhaseTimer phase(tracing::Phase::DATABASE);
+  std::vector< Task > tasks;
+  if (finished_)
   {
-    t.status_ = j["status"].get< std::string >();
+    return tasks;
   }
-  if (j.contains("created_at") && !j["created_at"].is_null())
-  {
-    std::string time_str = j["created_at"];
-    std::tm tm = {};
-    std::istringstream iss(time_str);
 
-    iss >> std::get_time(&tm, "%Y-%m-%dT%H:%M:%SZ");
-    if (!iss.fail())
+  try
+  {
+    pqxx::result result;
+    if (prefetched_)
     {
-      t.created_at_ = std::chrono::system_clock::from_time_t(timegm(&tm));
+      result = std::move(prefetched_.value());
+      prefetched_.reset();
     }
     else
     {
-      throw std::runtime_error("Invalid date format");
+      result = txn_.exec(fetch_query());
+    }
+
+    tasks.reserve(result.size());
+    for (size_t i = 0; i != result.size(); ++i)
+    {
+      tasks.push_back(Database::row_to_task(result[i]));
+    }
+
+    if (result.size() < batch_size_)
+    {
+      finished_ = true;
+      txn_.commit();
     }
   }
-  else
+  catch (const pqxx::sql_error& e)
   {
-    t.created_at_ = std::chrono::system_clock::now();
+    throw std::runtime_error(e.what());
   }
+
+  return tasks;
+}
+
+std::string database::TaskStream::fetch_query() const
+{
+  return "FETCH FORWARD " + std::to_string(batch_size_) + " FROM tasks_stream";
 }
 
-database::Database::Database(const std::string& connection_string):
+bool database::TaskStream::is_finished() const
+{
+  return finished_;
+}
+
+database::Database::Database(const std::string& connection_string, const DatabaseConfig& config):
   connection_string_(connection_string),
-  connection_(std::make_unique< pqxx::connection >(connection_string_))
-{}
+  pool_(connection_string_, config.pool),
+  cache_(),
+  group_committer_(),
+  invalidation_listener_(),
+  instance_id_(std::random_device()()),
+  change_counter_(0),
+  max_streams_(get_stream_limit(config)),
+  active_streams_(0)
+{
+  if (config.cache_capacity != 0)
+  {
+    cache_ = std::make_unique< TaskCache >(config.cache_capacity, config.cache_shards);
+  }
+
+  if (config.group_commit.enabled)
+  {
+    group_committer_ = std::make_unique< GroupCommitter >(config.group_commit, [this](const std::vector< Task >& tasks)
+    {
+      return insert_tasks(tasks);
+    });
+  }
+}
+
+database::Database::~Database()
+{
+  invalidation_listener_.request_stop();
+  if (invalidation_listener_.joinable())
+  {
+    invalidation_listener_.join();
+  }
+}
 
 void database::Database::initialize_database()
 {
-  std::lock_guard< std::mutex > lock(db_mutex_);
   try
   {
-    pqxx::work txn(*connection_);
-
-    bool table_exists = false;
-    try
-    {
-      auto result = txn.exec("SELECT to_regclass('public.tasks')");
-      table_exists = !result[0][0].is_null();
-    }
-    catch (const pqxx::undefined_table&)
-    {
-      table_exists = false;
-    }
+    auto connection = pool_.acquire();
+    pqxx::work txn(*connection);
 
-    if (table_exists)
-    {
-      return;
-    }
+    pqxx::pipeline pipeline(txn);
 
-    txn.exec(R"(
-      CREATE TABLE tasks (
+    pipeline.insert(R"(
+      CREATE TABLE IF NOT EXISTS tasks (
         id INT PRIMARY KEY GENERATED ALWAYS AS IDENTITY,
         title VARCHAR(255) NOT NULL,
         description TEXT,
         status VARCHAR(50) NOT NULL,
-        created_at BIGINT NOT NULL
+        created_at BIGINT NOT NULL,
+        version INT NOT NULL DEFAULT 1
       )
     )");
+    pipeline.insert("ALTER TABLE tasks ADD COLUMN IF NOT EXISTS version INT NOT NULL DEFAULT 1");
+
+    // Triggers are created only when missing: recreating them locks tasks and leaves other instances without invalidations
+    pipeline.insert(R"(
+      DO $do$
+      BEGIN
+        PERFORM pg_advisory_xact_lock(hashtext('tasks_triggers'));
+
+        IF to_regprocedure('notify_task_changed()') IS NULL THEN
+          CREATE FUNCTION notify_task_changed() RETURNS trigger AS $$
+          BEGIN
+            PERFORM pg_notify('tasks_changed', OLD.id::text);
+            RETURN NULL;
+          END;
+          $$ LANGUAGE plpgsql;
+        END IF;
+        IF to_regprocedure('notify_tasks_inserted()') IS NULL THEN
+          CREATE FUNCTION notify_tasks_inserted() RETURNS trigger AS $$
+          BEGIN
+            PERFORM pg_notify('tasks_changed', '');
+            RETURN NULL;
+          END;
+          $$ LANGUAGE plpgsql;
+        END IF;
+
+        IF NOT EXISTS (SELECT 1 FROM pg_trigger WHERE tgrelid = 'tasks'::regclass AND tgname = 'tasks_changed') THEN
+          CREATE TRIGGER tasks_changed AFTER UPDATE OR DELETE ON tasks
+            FOR EACH ROW EXECUTE FUNCTION notify_task_changed();
+        END IF;
+        IF NOT EXISTS (SELECT 1 FROM pg_trigger WHERE tgrelid = 'tasks'::regclass AND tgname = 'tasks_inserted') THEN
+          CREATE TRIGGER tasks_inserted AFTER INSERT ON tasks
+            FOR EACH STATEMENT EXECUTE FUNCTION notify_tasks_inserted();
+        END IF;
+      END
+      $do$
+    )");
+
+    pipeline.insert("CREATE INDEX IF NOT EXISTS tasks_created_at_id_idx ON tasks (created_at, id)");
+    pipeline.insert("CREATE INDEX IF NOT EXISTS tasks_status_created_at_id_idx ON tasks (lower(status), created_at, id)");
+
+    pipeline.complete();
+    while (!pipeline.empty())
+    {
+      pipeline.retrieve();
+    }
 
     txn.commit();
   }
@@ -162,22 +271,68 @@ void database::Database::initialize_database()
   {
     throw std::runtime_error(e.what());
   }
+
+  pool_.set_initializer(&Database::prepare_statements);
+
+  if (!invalidation_listener_.joinable())
+  {
+    invalidation_listener_ = std::jthread([this](std::stop_token stop_token)
+    {
+      listen_for_invalidations(stop_token);
+    });
+  }
+}
+
+std::string database::Database::get_change_tag() const
+{
+  return std::format("{:x}-{}", instance_id_, change_counter_.load(std::memory_order_acquire));
+}
+
+std::optional< int > database::Database::peek_task_version(int id) const
+{
+  if (!cache_)
+  {
+    return std::nullopt;
+  }
+
+  auto task = cache_->get(id);
+  return task ? task->get_version() : std::nullopt;
+}
+
+database::PoolStats database::Database::get_pool_stats() const
+{
+  return pool_.get_stats();
+}
+
+database::CacheStats database::Database::get_cache_stats() const
+{
+  return cache_ ? cache_->get_stats() : CacheStats();
+}
+
+database::GroupCommitStats database::Database::get_group_commit_stats() const
+{
+  return group_committer_ ? group_committer_->get_stats() : GroupCommitStats();
 }
 
 int database::Database::create_task(const Task& task)
 {
-  std::lock_guard< std::mutex > lock(db_mutex_);
+  metrics::DbTimer timer(metrics::DbOperation::CREATE_TASK);
+  tracing::PhaseTimer phase(tracing::Phase::DATABASE);
+  if (group_committer_)
+  {
+    return group_committer_->submit(task);
+  }
+
   try
   {
-    pqxx::work txn(*connection_);
+    auto connection = pool_.acquire();
+    pqxx::work txn(*connection);
 
     auto timestamp = std::chrono::duration_cast< std::chrono::seconds >(
       task.get_created_at().time_since_epoch()).count();
 
     auto result = txn.exec(
-      "INSERT INTO tasks (title, description, status, created_at) "
-      "VALUES ($1, $2, $3, $4) "
-      "RETURNING id",
+      pqxx::prepped{ "create_task" },
       pqxx::params {
         task.get_title().value_or(""),
         task.get_description().value_or(""),
@@ -187,6 +342,7 @@ int database::Database::create_task(const Task& task)
     );
 
     txn.commit();
+    record_change();
     return result[0][0].as< int >();
   }
   catch (const pqxx::sql_error& e)
@@ -195,141 +351,285 @@ int database::Database::create_task(const Task& task)
   }
 }
 
-std::vector< database::Task > database::Database::get_all_tasks()
+std::vector< int > database::Database::create_tasks(const std::vector< Task >& tasks)
 {
-  std::vector< Task > tasks;
+  metrics::DbTimer timer(metrics::DbOperation::CREATE_TASKS);
+  tracing::PhaseTimer phase(tracing::Phase::DATABASE);
+  std::vector< int > ids;
+  if (tasks.empty())
+  {
+    return ids;
+  }
 
   try
   {
-    pqxx::read_transaction txn(*connection_);
+    auto connection = pool_.acquire();
+    pqxx::work txn(*connection);
 
-    auto result = txn.exec(
-      "SELECT id, title, description, status, created_at FROM tasks "
-      "ORDER BY created_at DESC"
-    );
-
-    for (size_t i = 0; i != result.size(); ++i)
+    // tasks_import is created once per pooled connection, so the batch costs only COPY plus one statement
+    auto stream = pqxx::stream_to::table(txn, { "tasks_import" },
+      { "position", "title", "description", "status", "created_at" });
+    for (size_t i = 0; i != tasks.size(); ++i)
     {
-      tasks.push_back(row_to_task(result[i]));
+      auto timestamp = std::chrono::duration_cast< std::chrono::seconds >(
+        tasks[i].get_created_at().time_since_epoch()).count();
+
+      stream.write_values(
+        static_cast< int >(i),
+        tasks[i].get_title().value_or(""),
+        tasks[i].get_description().value_or(""),
+        tasks[i].get_status().value_or("In progress"),
+        timestamp
+      );
     }
+    stream.complete();
+
+    auto result = txn.exec(pqxx::prepped{ "import_tasks" });
+
+    txn.commit();
+    record_change();
+
+    ids = result_to_ids(result, tasks.size(), 0);
   }
   catch (const pqxx::sql_error& e)
   {
     throw std::runtime_error(e.what());
   }
 
-  return tasks;
+  return ids;
 }
 
-std::optional< database::Task > database::Database::get_task_by_id(int id)
+std::vector< int > database::Database::insert_tasks(const std::vector< Task >& tasks)
 {
+  std::vector< std::string > titles;
+  std::vector< std::string > descriptions;
+  std::vector< std::string > statuses;
+  std::vector< long long > timestamps;
+
+  titles.reserve(tasks.size());
+  descriptions.reserve(tasks.size());
+  statuses.reserve(tasks.size());
+  timestamps.reserve(tasks.size());
+  for (const Task& task : tasks)
+  {
+    titles.push_back(task.get_title().value_or(""));
+    descriptions.push_back(task.get_description().value_or(""));
+    statuses.push_back(task.get_status().value_or("In progress"));
+    timestamps.push_back(std::chrono::duration_cast< std::chrono::seconds >(
+      task.get_created_at().time_since_epoch()).count());
+  }
+
+  std::vector< int > ids;
   try
   {
-    pqxx::read_transaction txn(*connection_);
+    auto connection = pool_.acquire();
+    pqxx::work txn(*connection);
 
     auto result = txn.exec(
-      "SELECT id, title, description, status, created_at FROM tasks "
-      "WHERE id = $1",
+      pqxx::prepped{ "insert_tasks" },
       pqxx::params {
-        id
+        titles,
+        descriptions,
+        statuses,
+        timestamps
       }
     );
 
-    if (result.empty())
-    {
-      return std::nullopt;
-    }
+    txn.commit();
+    record_change();
 
-    return row_to_task(result[0]);
+    ids = result_to_ids(result, tasks.size(), 1);
   }
   catch (const pqxx::sql_error& e)
   {
     throw std::runtime_error(e.what());
   }
+
+  return ids;
 }
 
-void database::Database::update_task(const Task& task)
+std::vector< database::Task > database::Database::get_all_tasks()
 {
-  std::lock_guard< std::mutex > lock(db_mutex_);
+  metrics::DbTimer timer(metrics::DbOperation::GET_ALL_TASKS);
+  tracing::PhaseTimer phase(tracing::Phase::DATABASE);
+  std::vector< Task > tasks;
 
-  int id = task.get_id().value();
+  try
+  {
+    auto connection = pool_.acquire();
+    pqxx::read_transaction txn(*connection);
 
-  auto current_task_opt = get_task_by_id(id);
+    auto result = txn.exec(pqxx::prepped{ "get_all_tasks" });
 
-  if (!current_task_opt.has_value())
+    for (size_t i = 0; i != result.size(); ++i)
+    {
+      tasks.push_back(row_to_task(result[i]));
+    }
+  }
+  catch (const pqxx::sql_error& e)
   {
-    throw std::runtime_error("Task with id " + std::to_string(id) + " does not exist");
+    throw std::runtime_error(e.what());
   }
 
-  auto current_task = current_task_opt.value();
+  return tasks;
+}
+
+database::TaskPage database::Database::get_tasks(const TaskQuery& query)
+{
+  metrics::DbTimer timer(metrics::DbOperation::GET_TASKS);
+  tracing::PhaseTimer phase(tracing::Phase::DATABASE);
+  TaskPage page;
 
   try
   {
-    pqxx::work txn(*connection_);
+    auto connection = pool_.acquire();
+    pqxx::read_transaction txn(*connection);
 
-    bool is_updated = false;
+    // Without a limit the statements run with LIMIT NULL and return every row
+    std::optional< long long > limit;
+    if (query.limit)
+    {
+      limit = static_cast< long long >(query.limit.value()) + 1;
+    }
+    pqxx::result result;
 
-    if (auto title = task.get_title())
+    if (query.status && query.cursor)
+    {
+      result = txn.exec(
+        pqxx::prepped{ "list_tasks_by_status_after" },
+        pqxx::params {
+          limit,
+          query.status.value(),
+          query.cursor->created_at,
+          query.cursor->id
+        }
+      );
+    }
+    else if (query.status)
+    {
+      result = txn.exec(
+        pqxx::prepped{ "list_tasks_by_status" },
+        pqxx::params {
+          limit,
+          query.status.value()
+        }
+      );
+    }
+    else if (query.cursor)
     {
-      is_updated = true;
-      current_task.set_title(title.value());
+      result = txn.exec(
+        pqxx::prepped{ "list_tasks_after" },
+        pqxx::params {
+          limit,
+          query.cursor->created_at,
+          query.cursor->id
+        }
+      );
+    }
+    else
+    {
+      result = txn.exec(
+        pqxx::prepped{ "list_tasks" },
+        pqxx::params {
+          limit
+        }
+      );
     }
 
-    if (auto description = task.get_description())
+    size_t count = std::min(result.size(), query.limit.value_or(result.size()));
+    page.tasks.reserve(count);
+    for (size_t i = 0; i != count; ++i)
     {
-      is_updated = true;
-      current_task.set_description(description.value());
+      page.tasks.push_back(row_to_task(result[i]));
     }
 
-    if (auto status = task.get_status())
+    if (result.size() > count && !page.tasks.empty())
     {
-      is_updated = true;
-      current_task.set_status(status.value());
+      const Task& last = page.tasks.back();
+      page.next_cursor = TaskCursor{
+        std::chrono::duration_cast< std::chrono::seconds >(last.get_created_at().time_since_epoch()).count(),
+        last.get_id().value()
+      };
     }
+  }
+  catch (const pqxx::sql_error& e)
+  {
+    throw std::runtime_error(e.what());
+  }
 
-    if (!is_updated)
+  return page;
+}
+
+std::unique_ptr< database::TaskStream > database::Database::stream_tasks(const std::optional< std::string >& status,
+  size_t batch_size)
+{
+  metrics::DbTimer timer(metrics::DbOperation::STREAM_TASKS);
+  tracing::PhaseTimer phase(tracing::Phase::DATABASE);
+
+  // A stream keeps its connection until the client has read everything, so streams never take the last free connection
+  size_t active = active_streams_.load(std::memory_order_relaxed);
+  do
+  {
+    if (active >= max_streams_)
     {
-      throw std::invalid_argument("Nothing to update");
+      return nullptr;
     }
+  }
+  while (!active_streams_.compare_exchange_weak(active, active + 1, std::memory_order_acquire, std::memory_order_relaxed));
 
-    txn.exec(
-      "UPDATE tasks SET title = $1, description = $2, status = $3 WHERE id = $4",
-      pqxx::params {
-        current_task.get_title().value(),
-        current_task.get_description().value(),
-        current_task.get_status().value(),
-        id
-      }
-    );
-    txn.commit();
+  try
+  {
+    return std::make_unique< TaskStream >(pool_.acquire(), active_streams_, status, batch_size);
   }
   catch (const pqxx::sql_error& e)
   {
+    active_streams_.fetch_sub(1, std::memory_order_release);
     throw std::runtime_error(e.what());
   }
+  catch (...)
+  {
+    active_streams_.fetch_sub(1, std::memory_order_release);
+    throw;
+  }
 }
 
-void database::Database::delete_task(int id)
+std::optional< database::Task > database::Database::get_task_by_id(int id)
 {
-  std::lock_guard< std::mutex > lock(db_mutex_);
-
-  if (!check_id_exists(id))
+  metrics::DbTimer timer(metrics::DbOperation::GET_TASK_BY_ID);
+  tracing::PhaseTimer phase(tracing::Phase::DATABASE);
+  uint64_t epoch = 0;
+  if (cache_)
   {
-    throw std::runtime_error("Task with id " + std::to_string(id) + " does not exist");
+    if (auto task = cache_->get(id))
+    {
+      return task;
+    }
+    epoch = cache_->get_epoch(id);
   }
 
   try
   {
-    pqxx::work txn(*connection_);
+    auto connection = pool_.acquire();
+    pqxx::read_transaction txn(*connection);
 
-    txn.exec(
-      "DELETE FROM tasks WHERE id = $1",
+    auto result = txn.exec(
+      pqxx::prepped{ "get_task_by_id" },
       pqxx::params {
         id
       }
     );
 
-    txn.commit();
+    if (result.empty())
+    {
+      return std::nullopt;
+    }
+
+    Task task = row_to_task(result[0]);
+    if (cache_)
+    {
+      cache_->put(id, task, epoch);
+    }
+    return task;
   }
   catch (const pqxx::sql_error& e)
   {
@@ -337,36 +637,263 @@ void database::Database::delete_task(int id)
   }
 }
 
-database::Task database::Database::row_to_task(const pqxx::row& row) const
+int database::Database::update_task(const Task& task)
 {
-  int id = row["id"].as< int >();
-  std::string title = row["title"].as< std::string >();
-  std::string description = row["description"].as< std::string >("");
-  std::string status = row["status"].as< std::string >();
-  long long created_at_seconds = row["created_at"].as< long long >();
+  std::vector< int > expected_versions;
+  if (task.get_version())
+  {
+    expected_versions.push_back(task.get_version().value());
+  }
+  return update_task(task, expected_versions);
+}
 
-  auto created_at = std::chrono::system_clock::time_point(std::chrono::seconds(created_at_seconds));
+int database::Database::update_task(const Task& task, const std::vector< int >& expected_versions)
+{
+  metrics::DbTimer timer(metrics::DbOperation::UPDATE_TASK);
+  tracing::PhaseTimer phase(tracing::Phase::DATABASE);
+  int id = task.get_id().value();
+
+  if (!task.get_title() && !task.get_description() && !task.get_status())
+  {
+    throw std::invalid_argument("Nothing to update");
+  }
 
-  return Task(id, title, description, status, created_at);
+  try
+  {
+    auto connection = pool_.acquire();
+    pqxx::work txn(*connection);
+
+    auto result = txn.exec(
+      pqxx::prepped{ "update_task" },
+      pqxx::params {
+        id,
+        task.get_title(),
+        task.get_description(),
+        task.get_status(),
+        expected_versions
+      }
+    );
+
+    txn.commit();
+
+    if (result[0]["version"].is_null())
+    {
+      if (!result[0]["task_exists"].as< bool >())
+      {
+        throw TaskNotFoundError(id);
+      }
+      throw VersionConflictError(id, expected_versions);
+    }
+
+    record_change();
+    if (cache_)
+    {
+      cache_->invalidate(id);
+    }
+
+    return result[0]["version"].as< int >();
+  }
+  catch (const pqxx::sql_error& e)
+  {
+    throw std::runtime_error(e.what());
+  }
 }
 
-bool database::Database::check_id_exists(int id) const
+void database::Database::delete_task(int id)
 {
+  metrics::DbTimer timer(metrics::DbOperation::DELETE_TASK);
+  tracing::PhaseTimer phase(tracing::Phase::DATABASE);
   try
   {
-    pqxx::read_transaction txn(*connection_);
+    auto connection = pool_.acquire();
+    pqxx::work txn(*connection);
 
     auto result = txn.exec(
-      "SELECT EXISTS(SELECT 1 FROM tasks WHERE id = $1)",
+      pqxx::prepped{ "delete_task" },
       pqxx::params {
         id
       }
     );
 
-    return result[0][0].as< bool >();
+    txn.commit();
+
+    if (result.empty())
+    {
+      throw TaskNotFoundError(id);
+    }
+
+    record_change();
+    if (cache_)
+    {
+      cache_->invalidate(id);
+    }
   }
   catch (const pqxx::sql_error& e)
   {
     throw std::runtime_error(e.what());
   }
 }
+
+void database::Database::record_change()
+{
+  change_counter_.fetch_add(1, std::memory_order_acq_rel);
+}
+
+void database::Database::listen_for_invalidations(std::stop_token stop_token)
+{
+  while (!stop_token.stop_requested())
+  {
+    try
+    {
+      pqxx::connection connection(connection_string_);
+      connection.listen(invalidation_channel, [this](pqxx::notification notification)
+      {
+        record_change();
+
+        int id = 0;
+        auto [ptr, ec] = std::from_chars(notification.payload.data(),
+          notification.payload.data() + notification.payload.size(), id);
+        if (cache_ && ec == std::errc())
+        {
+          cache_->invalidate(id);
+        }
+      });
+
+      record_change();
+      if (cache_)
+      {
+        cache_->clear();
+      }
+
+      while (!stop_token.stop_requested())
+      {
+        connection.await_notification(0, 200000);
+      }
+    }
+    catch (const std::exception& e)
+    {
+      record_change();
+      if (cache_)
+      {
+        cache_->clear();
+      }
+      LOG(logger::LogLevel::WARNING, "Task invalidation listener failed: {}", e.what());
+      std::mutex retry_mutex;
+      std::unique_lock< std::mutex > retry_lock(retry_mutex);
+      std::condition_variable_any().wait_for(retry_lock, stop_token, std::chrono::seconds(1), []()
+      {
+        return false;
+      });
+    }
+  }
+}
+
+void database::Database::prepare_statements(pqxx::connection& connection)
+{
+  // A connection from an older initializer generation still holds the previous statements
+  {
+    pqxx::nontransaction txn(connection);
+    txn.exec("DEALLOCATE ALL");
+    txn.exec(R"(
+      CREATE TEMP TABLE IF NOT EXISTS tasks_import (
+        position INT NOT NULL,
+        title VARCHAR(255) NOT NULL,
+        description TEXT,
+        status VARCHAR(50) NOT NULL,
+        created_at BIGINT NOT NULL
+      ) ON COMMIT DELETE ROWS
+    )");
+  }
+
+  connection.prepare("create_task",
+    "INSERT INTO tasks (title, description, status, created_at) "
+    "VALUES ($1, $2, $3, $4) "
+    "RETURNING id"
+  );
+  connection.prepare("insert_tasks",
+    "WITH numbered AS MATERIALIZED ("
+    "  SELECT position, nextval(pg_get_serial_sequence('tasks', 'id'))::INT AS id, "
+    "    title, description, status, created_at "
+    "  FROM unnest($1::VARCHAR[], $2::TEXT[], $3::VARCHAR[], $4::BIGINT[]) "
+    "  WITH ORDINALITY AS batch(title, description, status, created_at, position)"
+    "), inserted AS ("
+    "  INSERT INTO tasks (id, title, description, status, created_at) OVERRIDING SYSTEM VALUE "
+    "  SELECT id, title, description, status, created_at FROM numbered"
+    ") "
+    "SELECT position, id FROM numbered"
+  );
+  // Ids are drawn from the identity sequence per row first, so each one is tied to its position explicitly
+  connection.prepare("import_tasks",
+    "WITH numbered AS MATERIALIZED ("
+    "  SELECT position, nextval(pg_get_serial_sequence('tasks', 'id'))::INT AS id, "
+    "    title, description, status, created_at "
+    "  FROM tasks_import"
+    "), inserted AS ("
+    "  INSERT INTO tasks (id, title, description, status, created_at) OVERRIDING SYSTEM VALUE "
+    "  SELECT id, title, description, status, created_at FROM numbered"
+    ") "
+    "SELECT position, id FROM numbered"
+  );
+  connection.prepare("get_all_tasks",
+    "SELECT id, title, description, status, created_at, version FROM tasks "
+    "ORDER BY created_at DESC"
+  );
+  connection.prepare("list_tasks",
+    "SELECT id, title, description, status, created_at, version FROM tasks "
+    "ORDER BY created_at DESC, id DESC "
+    "LIMIT $1"
+  );
+  connection.prepare("list_tasks_after",
+    "SELECT id, title, description, status, created_at, version FROM tasks "
+    "WHERE (created_at, id) < ($2, $3) "
+    "ORDER BY created_at DESC, id DESC "
+    "LIMIT $1"
+  );
+  connection.prepare("list_tasks_by_status",
+    "SELECT id, title, description, status, created_at, version FROM tasks "
+    "WHERE lower(status) = lower($2) "
+    "ORDER BY created_at DESC, id DESC "
+    "LIMIT $1"
+  );
+  connection.prepare("list_tasks_by_status_after",
+    "SELECT id, title, description, status, created_at, version FROM tasks "
+    "WHERE lower(status) = lower($2) AND (created_at, id) < ($3, $4) "
+    "ORDER BY created_at DESC, id DESC "
+    "LIMIT $1"
+  );
+  connection.prepare("get_task_by_id",
+    "SELECT id, title, description, status, created_at, version FROM tasks "
+    "WHERE id = $1"
+  );
+  connection.prepare("update_task",
+    "WITH updated AS ("
+    "  UPDATE tasks SET "
+    "    title = COALESCE($2, title), "
+    "    description = COALESCE($3, description), "
+    "    status = COALESCE($4, status), "
+    "    version = version + 1 "
+    "  WHERE id = $1 AND (cardinality($5::INT[]) = 0 OR version = ANY($5::INT[])) "
+    "  RETURNING version"
+    ") "
+    "SELECT (SELECT version FROM updated) AS version, "
+    "EXISTS(SELECT 1 FROM tasks WHERE id = $1) AS task_exists"
+  );
+  connection.prepare("delete_task",
+    "DELETE FROM tasks WHERE id = $1 RETURNING id"
+  );
+}
+
+database::Task database::Database::row_to_task(const pqxx::row& row)
+{
+  int id = row["id"].as< int >();
+  std::string title = row["title"].as< std::string >();
+  std::string description = row["description"].as< std::string >("");
+  std::string status = row["status"].as< std::string >();
+  long long created_at_seconds = row["created_at"].as< long long >();
+
+  auto created_at = std::chrono::system_clock::time_point(std::chrono::seconds(created_at_seconds));
+
+  Task task(id, title, description, status, created_at);
+  task.set_version(row["version"].as< int >());
+  return task;
+}
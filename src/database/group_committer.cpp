@@ -0,0 +1,129 @@
+#include "group_committer.hpp"
+#include <algorithm>
+
+database::GroupCommitter::GroupCommitter(const GroupCommitConfig& config, Flush flush):
+  config_(config),
+  flush_(std::move(flush)),
+  queue_(),
+  stats_(),
+  flusher_()
+{
+  config_.max_batch_size = std::max(static_cast< size_t >(1), config_.max_batch_size);
+
+  flusher_ = std::jthread([this](std::stop_token stop_token)
+  {
+    run(stop_token);
+  });
+}
+
+database::GroupCommitter::~GroupCommitter()
+{
+  flusher_.request_stop();
+  if (flusher_.joinable())
+  {
+    flusher_.join();
+  }
+
+  for (Pending& pending : queue_)
+  {
+    pending.id.set_exception(std::make_exception_ptr(std::runtime_error("Group commit stopped")));
+  }
+}
+
+int database::GroupCommitter::submit(const Task& task)
+{
+  std::future< int > id;
+  {
+    std::lock_guard< std::mutex > lock(queue_mutex_);
+    queue_.push_back({ task, std::promise< int >() });
+    id = queue_.back().id.get_future();
+  }
+  queue_changed_.notify_one();
+
+  return id.get();
+}
+
+database::GroupCommitStats database::GroupCommitter::get_stats() const
+{
+  std::lock_guard< std::mutex > lock(queue_mutex_);
+  return stats_;
+}
+
+void database::GroupCommitter::run(std::stop_token stop_token)
+{
+  std::vector< Pending > batch;
+  std::vector< Task > tasks;
+
+  while (!stop_token.stop_requested())
+  {
+    {
+      std::unique_lock< std::mutex > lock(queue_mutex_);
+      if (!queue_changed_.wait(lock, stop_token, [this]()
+      {
+        return !queue_.empty();
+      }))
+      {
+        return;
+      }
+
+      auto deadline = std::chrono::steady_clock::now() + config_.window;
+      queue_changed_.wait_until(lock, stop_token, deadline, [this]()
+      {
+        return queue_.size() >= config_.max_batch_size;
+      });
+
+      size_t count = std::min(queue_.size(), config_.max_batch_size);
+      batch.assign(std::make_move_iterator(queue_.begin()), std::make_move_iterator(queue_.begin() + count));
+      queue_.erase(queue_.begin(), queue_.begin() + count);
+    }
+
+    tasks.clear();
+    for (const Pending& pending : batch)
+    {
+      tasks.push_back(pending.task);
+    }
+
+    bool failed = false;
+    try
+    {
+      auto ids = flush_(tasks);
+      if (ids.size() != batch.size())
+      {
+        throw std::runtime_error("Group commit returned " + std::to_string(ids.size()) + " ids for " +
+          std::to_string(batch.size()) + " tasks");
+      }
+
+      for (size_t i = 0; i != batch.size(); ++i)
+      {
+        batch[i].id.set_value(ids[i]);
+      }
+    }
+    catch (...)
+    {
+      failed = true;
+      for (Pending& pending : batch)
+      {
+        pending.id.set_exception(std::current_exception());
+      }
+    }
+
+    record_batch(batch.size(), failed);
+    batch.clear();
+  }
+}
+
+void database::GroupCommitter::record_batch(size_t size, bool failed)
+{
+  std::lock_guard< std::mutex > lock(queue_mutex_);
+
+  ++stats_.batches;
+  stats_.tasks += size;
+  stats_.largest_batch = std::max(stats_.largest_batch, size);
+  if (failed)
+  {
+    ++stats_.failed_batches;
+  }
+
+  auto bucket = std::lower_bound(GroupCommitStats::bucket_bounds.begin(), GroupCommitStats::bucket_bounds.end(), size);
+  ++stats_.batch_sizes[bucket - GroupCommitStats::bucket_bounds.begin()];
+}
@@ -0,0 +1,424 @@
+#include "task.hpp"
+#include <charconv>
+#include <iomanip>
+#include <simdjson.h>
+#include <sstream>
+#include "tracing.hpp"
+
+database::JsonFormatError::JsonFormatError():
+  std::runtime_error("Wrong JSON format")
+{}
+
+database::Task::Task(int id):
+  id_(id),
+  title_(),
+  description_(),
+  status_(),
+  created_at_(std::chrono::system_clock::now()),
+  version_()
+{}
+
+database::Task::Task(int id, std::string title, std::string description, std::string status, 
+  std::chrono::system_clock::time_point created_at):
+  id_(id),
+  title_(title),
+  description_(description),
+  status_(status),
+  created_at_(created_at),
+  version_()
+{}
+
+std::optional< int > database::Task::get_id() const
+{
+  return id_;
+}
+
+std::optional< std::string > database::Task::get_title() const
+{
+  return title_;
+}
+
+std::optional< std::string > database::Task::get_description() const
+{
+  return description_;
+}
+
+std::optional< std::string > database::Task::get_status() const
+{
+  return status_;
+}
+
+std::chrono::system_clock::time_point database::Task::get_created_at() const
+{
+  return created_at_;
+}
+
+std::optional< int > database::Task::get_version() const
+{
+  return version_;
+}
+
+void database::Task::set_id(const std::optional< int >& id)
+{
+  id_ = id;
+}
+
+void database::Task::set_title(const std::optional< std::string >& title)
+{
+  title_ = title;
+}
+
+void database::Task::set_description(const std::optional< std::string >& description)
+{
+  description_ = description;
+}
+
+void database::Task::set_status(const std::optional< std::string >& status)
+{
+  status_ = status;
+}
+
+void database::Task::set_version(const std::optional< int >& version)
+{
+  version_ = version;
+}
+
+void database::to_json(nlohmann::json& j, const Task& t)
+{
+  std::string created_at;
+  append_timestamp(created_at, t.created_at_);
+
+  j = nlohmann::json{
+    { "id", t.id_.value() },
+    { "title", t.title_.value() },
+    { "description", t.description_.value() },
+    { "status", t.status_.value() },
+    { "created_at", std::move(created_at) }
+  };
+
+  if (t.version_)
+  {
+    j["version"] = t.version_.value();
+  }
+}
+
+void database::from_json(const nlohmann::json& j, Task& t)
+{
+  if (j.contains("id") && !j["id"].is_null())
+  {
+    t.id_ = j["id"].get< int >();
+  }
+  if (j.contains("title") && !j["title"].is_null())
+  {
+    t.title_ = j["title"].get< std::string >();
+  }
+  if (j.contains("description") && !j["description"].is_null())
+  {
+    t.description_ = j["description"].get< std::string >();
+  }
+  if (j.contains("status") && !j["status"].is_null())
+  {
+    t.status_ = j["status"].get< std::string >();
+  }
+  if (j.contains("version") && !j["version"].is_null())
+  {
+    t.version_ = j["version"].get< int >();
+  }
+  if (j.contains("created_at") && !j["created_at"].is_null())
+  {
+    std::string time_str = j["created_at"];
+    t.created_at_ = parse_timestamp(time_str);
+  }
+  else
+  {
+    t.created_at_ = std::chrono::system_clock::now();
+  }
+}
+
+void database::parse_task(std::string_view json, Task& task)
+{
+  tracing::PhaseTimer timer(tracing::Phase::PARSE);
+  thread_local simdjson::dom::parser parser;
+  thread_local std::string buffer;
+
+  buffer.reserve(json.size() + simdjson::SIMDJSON_PADDING);
+  buffer.assign(json);
+
+  simdjson::dom::element root;
+  if (parser.parse(buffer.data(), json.size(), false).get(root))
+  {
+    throw JsonFormatError();
+  }
+
+  std::optional< simdjson::dom::element > id;
+  std::optional< simdjson::dom::element > title;
+  std::optional< simdjson::dom::element > description;
+  std::optional< simdjson::dom::element > status;
+  std::optional< simdjson::dom::element > version;
+  std::optional< simdjson::dom::element > created_at;
+
+  simdjson::dom::object object;
+  if (!root.get(object))
+  {
+    for (auto field : object)
+    {
+      if (field.key == "id")
+      {
+        id = field.value;
+      }
+      else if (field.key == "title")
+      {
+        title = field.value;
+      }
+      else if (field.key == "description")
+      {
+        description = field.value;
+      }
+      else if (field.key == "status")
+      {
+        status = field.value;
+      }
+      else if (field.key == "version")
+      {
+        version = field.value;
+      }
+      else if (field.key == "created_at")
+      {
+        created_at = field.value;
+      }
+    }
+  }
+
+  auto type_name = [](const simdjson::dom::element& element) -> std::string
+  {
+    switch (element.type())
+    {
+    case simdjson::dom::element_type::ARRAY:
+      return "array";
+    case simdjson::dom::element_type::OBJECT:
+      return "object";
+    case simdjson::dom::element_type::STRING:
+      return "string";
+    case simdjson::dom::element_type::BOOL:
+      return "boolean";
+    case simdjson::dom::element_type::NULL_VALUE:
+      return "null";
+    default:
+      return "number";
+    }
+  };
+
+  auto is_set = [](const std::optional< simdjson::dom::element >& element)
+  {
+    return element && !element->is_null();
+  };
+
+  auto get_int = [&type_name](const simdjson::dom::element& element)
+  {
+    switch (element.type())
+    {
+    case simdjson::dom::element_type::INT64:
+      return static_cast< int >(int64_t(element));
+    case simdjson::dom::element_type::UINT64:
+      return static_cast< int >(uint64_t(element));
+    case simdjson::dom::element_type::DOUBLE:
+      return static_cast< int >(double(element));
+    case simdjson::dom::element_type::BOOL:
+      return static_cast< int >(bool(element));
+    default:
+      throw std::invalid_argument("[json.exception.type_error.302] type must be number, but is " + type_name(element));
+    }
+  };
+
+  auto get_string = [&type_name](const simdjson::dom::element& element)
+  {
+    if (!element.is_string())
+    {
+      throw std::invalid_argument("[json.exception.type_error.302] type must be string, but is " + type_name(element));
+    }
+    return std::string(std::string_view(element));
+  };
+
+  if (is_set(id))
+  {
+    task.id_ = get_int(id.value());
+  }
+  if (is_set(title))
+  {
+    task.title_ = get_string(title.value());
+  }
+  if (is_set(description))
+  {
+    task.description_ = get_string(description.value());
+  }
+  if (is_set(status))
+  {
+    task.status_ = get_string(status.value());
+  }
+  if (is_set(version))
+  {
+    task.version_ = get_int(version.value());
+  }
+  if (is_set(created_at))
+  {
+    task.created_at_ = parse_timestamp(get_string(created_at.value()));
+  }
+  else
+  {
+    task.created_at_ = std::chrono::system_clock::now();
+  }
+}
+
+std::chrono::system_clock::time_point database::parse_timestamp(const std::string& timestamp)
+{
+  std::tm tm = {};
+  std::istringstream iss(timestamp);
+
+  iss >> std::get_time(&tm, "%Y-%m-%dT%H:%M:%SZ");
+  if (iss.fail())
+  {
+    throw std::runtime_error("Invalid date format");
+  }
+  return std::chrono::system_clock::from_time_t(timegm(&tm));
+}
+
+void database::append_json(std::string& buffer, const Task& task)
+{
+  tracing::PhaseTimer timer(tracing::Phase::SERIALIZE);
+  char number[16];
+
+  buffer += R"({"created_at":")";
+  append_timestamp(buffer, task.created_at_);
+  buffer += R"(","description":)";
+  append_json_string(buffer, task.description_.value());
+  buffer += R"(,"id":)";
+  buffer.append(number, std::to_chars(number, number + sizeof(number), task.id_.value()).ptr);
+  buffer += R"(,"status":)";
+  append_json_string(buffer, task.status_.value());
+  buffer += R"(,"title":)";
+  append_json_string(buffer, task.title_.value());
+  if (task.version_)
+  {
+    buffer += R"(,"version":)";
+    buffer.append(number, std::to_chars(number, number + sizeof(number), task.version_.value()).ptr);
+  }
+  buffer.push_back('}');
+}
+
+void database::append_json(std::string& buffer, const std::vector< Task >& tasks)
+{
+  tracing::PhaseTimer timer(tracing::Phase::SERIALIZE);
+  // Per-task append_json calls below must not time themselves again.
+  tracing::ActiveTrace per_task(nullptr);
+
+  buffer.push_back('[');
+  for (size_t i = 0; i != tasks.size(); ++i)
+  {
+    if (i != 0)
+    {
+      buffer.push_back(',');
+    }
+    append_json(buffer, tasks[i]);
+  }
+  buffer.push_back(']');
+}
+
+void database::append_json_string(std::string& buffer, std::string_view value)
+{
+  static constexpr char hex_digits[] = "0123456789abcdef";
+
+  buffer.push_back('"');
+
+  size_t plain_start = 0;
+  for (size_t i = 0; i != value.size(); ++i)
+  {
+    unsigned char c = static_cast< unsigned char >(value[i]);
+    if (c >= 0x20 && c != '"' && c != '\\')
+    {
+      if (c < 0x80)
+      {
+        continue;
+      }
+
+      size_t length = c >= 0xF0 ? 4 : c >= 0xE0 ? 3 : 2;
+      unsigned char second = i + 1 < value.size() ? static_cast< unsigned char >(value[i + 1]) : 0;
+      bool valid = c >= 0xC2 && c <= 0xF4 && i + length <= value.size()
+        && (c != 0xE0 || second >= 0xA0) && (c != 0xED || second < 0xA0)
+        && (c != 0xF0 || second >= 0x90) && (c != 0xF4 || second < 0x90);
+      for (size_t j = 1; valid && j != length; ++j)
+      {
+        valid = (static_cast< unsigned char >(value[i + j]) & 0xC0) == 0x80;
+      }
+      if (!valid)
+      {
+        throw std::invalid_argument("Invalid UTF-8 in task field");
+      }
+
+      i += length - 1;
+      continue;
+    }
+
+    buffer.append(value.data() + plain_start, i - plain_start);
+    plain_start = i + 1;
+
+    switch (c)
+    {
+    case '"':
+      buffer += "\\\"";
+      break;
+    case '\\':
+      buffer += "\\\\";
+      break;
+    case '\b':
+      buffer += "\\b";
+      break;
+    case '\f':
+      buffer += "\\f";
+      break;
+    case '\n':
+      buffer += "\\n";
+      break;
+    case '\r':
+      buffer += "\\r";
+      break;
+    case '\t':
+      buffer += "\\t";
+      break;
+    default:
+      buffer += "\\u00";
+      buffer.push_back(hex_digits[c >> 4]);
+      buffer.push_back(hex_digits[c & 0x0F]);
+      break;
+    }
+  }
+  buffer.append(value.data() + plain_start, value.size() - plain_start);
+
+  buffer.push_back('"');
+}
+
+void database::append_timestamp(std::string& buffer, std::chrono::system_clock::time_point time_point)
+{
+  auto seconds = std::chrono::floor< std::chrono::seconds >(time_point);
+  auto days = std::chrono::floor< std::chrono::days >(seconds);
+  std::chrono::year_month_day date(days);
+  std::chrono::hh_mm_ss< std::chrono::seconds > time(seconds - days);
+
+  auto append_two_digits = [&buffer](unsigned value)
+  {
+    buffer.push_back(static_cast< char >('0' + value / 10));
+    buffer.push_back(static_cast< char >('0' + value % 10));
+  };
+
+  char year[16];
+  buffer.append(year, std::to_chars(year, year + sizeof(year), static_cast< int >(date.year())).ptr);
+  buffer.push_back('-');
+  append_two_digits(static_cast< unsigned >(date.month()));
+  buffer.push_back('-');
+  append_two_digits(static_cast< unsigned >(date.day()));
+  buffer.push_back(' ');
+  append_two_digits(static_cast< unsigned >(time.hours().count()));
+  buffer.push_back(':');
+  append_two_digits(static_cast< unsigned >(time.minutes().count()));
+  buffer.push_back(':');
+  append_two_digits(static_cast< unsigned >(time.seconds().count()));
+}
@@ -0,0 +1,118 @@
+#include "task_cache.hpp"
+
+database::TaskCache::TaskCache(size_t capacity, size_t shards_num):
+  shards_(std::max(static_cast< size_t >(1), shards_num)),
+  shard_capacity_((capacity + shards_.size() - 1) / shards_.size()),
+  hits_(0),
+  misses_(0),
+  evictions_(0),
+  invalidations_(0)
+{}
+
+std::optional< database::Task > database::TaskCache::get(int id)
+{
+  Shard& shard = shard_for(id);
+  std::lock_guard< std::mutex > lock(shard.mutex);
+
+  auto it = shard.index.find(id);
+  if (it == shard.index.end())
+  {
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    return std::nullopt;
+  }
+
+  shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+  hits_.fetch_add(1, std::memory_order_relaxed);
+  return it->second->second;
+}
+
+uint64_t database::TaskCache::get_epoch(int id)
+{
+  Shard& shard = shard_for(id);
+  std::lock_guard< std::mutex > lock(shard.mutex);
+  return shard.epoch;
+}
+
+void database::TaskCache::put(int id, const Task& task, uint64_t epoch)
+{
+  if (shard_capacity_ == 0)
+  {
+    return;
+  }
+
+  Shard& shard = shard_for(id);
+  std::lock_guard< std::mutex > lock(shard.mutex);
+
+  if (shard.epoch != epoch)
+  {
+    return;
+  }
+
+  auto it = shard.index.find(id);
+  if (it != shard.index.end())
+  {
+    it->second->second = task;
+    shard.entries.splice(shard.entries.begin(), shard.entries, it->second);
+    return;
+  }
+
+  shard.entries.emplace_front(id, task);
+  shard.index.emplace(id, shard.entries.begin());
+
+  if (shard.entries.size() > shard_capacity_)
+  {
+    shard.index.erase(shard.entries.back().first);
+    shard.entries.pop_back();
+    evictions_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void database::TaskCache::invalidate(int id)
+{
+  Shard& shard = shard_for(id);
+  std::lock_guard< std::mutex > lock(shard.mutex);
+
+  ++shard.epoch;
+
+  auto it = shard.index.find(id);
+  if (it != shard.index.end())
+  {
+    shard.entries.erase(it->second);
+    shard.index.erase(it);
+    invalidations_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void database::TaskCache::clear()
+{
+  for (Shard& shard : shards_)
+  {
+    std::lock_guard< std::mutex > lock(shard.mutex);
+
+    ++shard.epoch;
+    invalidations_.fetch_add(shard.entries.size(), std::memory_order_relaxed);
+    shard.index.clear();
+    shard.entries.clear();
+  }
+}
+
+database::CacheStats database::TaskCache::get_stats() const
+{
+  CacheStats stats;
+  stats.capacity = shard_capacity_ * shards_.size();
+  for (const Shard& shard : shards_)
+  {
+    std::lock_guard< std::mutex > lock(shard.mutex);
+    stats.size += shard.entries.size();
+  }
+  stats.hits = hits_.load(std::memory_order_relaxed);
+  stats.misses = misses_.load(std::memory_order_relaxed);
+  stats.evictions = evictions_.load(std::memory_order_relaxed);
+  stats.invalidations = invalidations_.load(std::memory_order_relaxed);
+  return stats;
+}
+
+database::TaskCache::Shard& database::TaskCache::shard_for(int id)
+{
+  return shards_[static_cast< unsigned int >(id) % shards_.size()];
+}
@@ -0,0 +1,64 @@
+#include "get_metrics_handler.hpp"
+#include <format>
+#include <iterator>
+#include "logger.hpp"
+#include "metrics.hpp"
+
+namespace
+{
+  void write_metric(std::string& out, std::string_view name, std::string_view type, std::string_view help, auto value)
+  {
+    std::format_to(std::back_inserter(out), "# HELP {} {}\n# TYPE {} {}\n{} {}\n", name, help, name, type, name, value);
+  }
+}
+
+handlers::GetMetricsHandler::GetMetricsHandler(std::shared_ptr< const server::AdmissionController > admission):
+  admission_(admission)
+{}
+
+http::response< http::string_body > handlers::GetMetricsHandler::handle_request(const http::request< http::string_body >&,
+  const RouteParams&, const std::shared_ptr< database::Database >& db) const
+{
+  std::string body;
+  body.reserve(64 * 1024);
+  metrics::Registry::get_instance().write_prometheus(body);
+
+  database::PoolStats pool = db->get_pool_stats();
+  write_metric(body, "todo_db_pool_connections", "gauge", "Open database connections.", pool.size);
+  write_metric(body, "todo_db_pool_idle_connections", "gauge", "Idle database connections.", pool.idle);
+  write_metric(body, "todo_db_pool_max_connections", "gauge", "Maximum database pool size.", pool.max_size);
+  write_metric(body, "todo_db_pool_waiting", "gauge", "Threads waiting for a database connection.", pool.waiting);
+  write_metric(body, "todo_db_pool_checkouts_total", "counter", "Database connection checkouts.", pool.checkouts);
+  write_metric(body, "todo_db_pool_timeouts_total", "counter", "Database connection checkouts that timed out.", pool.timeouts);
+  write_metric(body, "todo_db_pool_reconnects_total", "counter", "Database reconnects after failed health checks.",
+    pool.reconnects);
+  write_metric(body, "todo_db_pool_wait_seconds_total", "counter", "Time spent waiting for a database connection.",
+    std::chrono::duration< double >(pool.total_wait).count());
+
+  database::CacheStats cache = db->get_cache_stats();
+  write_metric(body, "todo_task_cache_entries", "gauge", "Tasks held in the read-through cache.", cache.size);
+  write_metric(body, "todo_task_cache_hits_total", "counter", "Task cache hits.", cache.hits);
+  write_metric(body, "todo_task_cache_misses_total", "counter", "Task cache misses.", cache.misses);
+
+  server::AdmissionStats admission = admission_->get_stats();
+  write_metric(body, "todo_admission_inflight", "gauge", "Admitted requests waiting for or running a handler.",
+    admission.inflight);
+  write_metric(body, "todo_admission_overloaded", "gauge", "Whether the queue delay check is shedding load.",
+    admission.overloaded ? 1 : 0);
+  write_metric(body, "todo_admission_rejected_sessions_total", "counter", "Connections refused over the session limit.",
+    admission.rejected_sessions);
+  write_metric(body, "todo_admission_shed_inflight_total", "counter", "Requests shed over the in-flight limit.",
+    admission.shed_inflight);
+  write_metric(body, "todo_admission_shed_queue_delay_total", "counter", "Requests shed by the queue delay check.",
+    admission.shed_queue_delay);
+
+  write_metric(body, "todo_log_dropped_total", "counter", "Log messages dropped on logger buffer overflow.",
+    logger::Logger::get_instance().get_dropped());
+
+  http::response< http::string_body > res(http::status::ok, 11);
+  res.set(http::field::content_type, "text/plain; version=0.0.4");
+  res.set(http::field::access_control_allow_origin, "*");
+  res.body() = std::move(body);
+  res.prepare_payload();
+  return res;
+}
@@ -1,54 +1,53 @@
 #include "get_task_handler.hpp"
 #include "http_utils.hpp"
 
-bool handlers::GetTaskHandler::can_handle(const http::request< http::string_body >& req) const
-{
-  auto params = utils::parse_parameters(req.target());
-  return req.method() == http::verb::get && params.size() == 3 && params[1] == "task";
-}
-
 http::response< http::string_body > handlers::GetTaskHandler::handle_request(const http::request< http::string_body >& req,
-  std::shared_ptr< database::Database >(db))
+  const RouteParams& params, const std::shared_ptr< database::Database >& db) const
 {
-  std::vector< std::string > params = utils::parse_parameters(req.target());
-
-  int id = 0;
-  try
-  {
-    id = std::stoi(params[2]);
-  }
-  catch (const std::invalid_argument& e)
+  auto id = params.get_int("id");
+  if (!id)
   {
     return utils::create_response(http::status::bad_request, true, "Wrong id");
   }
-  catch (const std::exception& e)
+
+  auto if_none_match = req[http::field::if_none_match];
+  if (!if_none_match.empty())
   {
-    return utils::create_response(http::status::bad_request, true, e.what());
+    if (auto version = db->peek_task_version(id.value()))
+    {
+      std::string etag = utils::make_version_tag(version.value());
+      if (utils::match_etag(if_none_match, etag))
+      {
+        return utils::create_not_modified_response(etag);
+      }
+    }
   }
 
-  nlohmann::json json;
+  std::optional< database::Task > task;
   try
   {
-    auto task = db->get_task_by_id(id);
-    if (task.has_value())
-    {
-      json = task;
-    }
+    task = db->get_task_by_id(id.value());
   }
   catch (const std::exception& e)
   {
     return utils::create_response(http::status::internal_server_error, true, e.what());
   }
 
-  if (json.empty())
+  if (!task)
   {
     return utils::create_response(http::status::ok, false, "No task with current id");
   }
 
-  return utils::create_json_response(http::status::ok, json);
-}
+  std::string etag = utils::make_version_tag(task->get_version().value_or(1));
+  if (!if_none_match.empty() && utils::match_etag(if_none_match, etag))
+  {
+    return utils::create_not_modified_response(etag);
+  }
 
-std::unique_ptr< handlers::RequestHandler > handlers::GetTaskHandler::create() const
-{
-  return std::make_unique< GetTaskHandler >();
+  std::string body;
+  database::append_json(body, task.value());
+
+  auto res = utils::create_raw_json_response(http::status::ok, std::move(body));
+  res.set(http::field::etag, etag);
+  return res;
 }
@@ -1,31 +1,168 @@
 #include "get_tasks_handler.hpp"
+#include <charconv>
 #include "http_utils.hpp"
 
-bool handlers::GetTasksHandler::can_handle(const http::request< http::string_body >& req) const
+namespace
 {
-  auto params = utils::parse_parameters(req.target());
-  return req.method() == http::verb::get && params.size() == 2 && params[1] == "tasks";
+  bool is_stream_requested(const std::unordered_map< std::string, std::string >& query)
+  {
+    auto stream = query.find("stream");
+    return stream != query.end() && (stream->second == "true" || stream->second == "1");
+  }
+}
+
+handlers::TaskListStream::TaskListStream(http::response< http::empty_body > header,
+  std::unique_ptr< database::TaskStream > tasks):
+  ResponseStream(std::move(header)),
+  tasks_(std::move(tasks)),
+  started_(false),
+  written_(0)
+{}
+
+bool handlers::TaskListStream::next_chunk(std::string& buffer)
+{
+  if (!started_)
+  {
+    started_ = true;
+    buffer.push_back('[');
+  }
+
+  auto tasks = tasks_->fetch();
+  for (size_t i = 0; i != tasks.size(); ++i)
+  {
+    if (written_ != 0)
+    {
+      buffer.push_back(',');
+    }
+    database::append_json(buffer, tasks[i]);
+    ++written_;
+  }
+
+  if (tasks_->is_finished())
+  {
+    buffer.push_back(']');
+    return false;
+  }
+  return true;
 }
 
 http::response< http::string_body > handlers::GetTasksHandler::handle_request(const http::request< http::string_body >& req,
-  std::shared_ptr< database::Database > db)
+  const RouteParams&, const std::shared_ptr< database::Database >& db) const
 {
-  std::vector< std::string > params = utils::parse_parameters(req.target());
+  auto query = utils::parse_query(req.target());
+
+  database::TaskQuery task_query;
+
+  if (auto limit = query.find("limit"); limit != query.end())
+  {
+    const std::string& value = limit->second;
+    size_t parsed_limit = 0;
+    auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), parsed_limit);
+    if (ec != std::errc() || ptr != value.data() + value.size() || parsed_limit == 0 || parsed_limit > max_limit)
+    {
+      return utils::create_response(http::status::bad_request, true,
+        "Limit must be between 1 and " + std::to_string(max_limit));
+    }
+    task_query.limit = parsed_limit;
+  }
+
+  if (auto cursor = query.find("cursor"); cursor != query.end())
+  {
+    task_query.cursor = database::decode_cursor(cursor->second);
+    if (!task_query.cursor)
+    {
+      return utils::create_response(http::status::bad_request, true, "Wrong cursor");
+    }
+  }
+
+  // Without limit or cursor the whole list is returned, as before pagination existed
+  if (task_query.cursor && !task_query.limit)
+  {
+    task_query.limit = default_limit;
+  }
+
+  if (auto status = query.find("status"); status != query.end())
+  {
+    if (utils::check_task_status(status->second))
+    {
+      return utils::create_response(http::status::bad_request, true, "Status must be 'Todo', 'In progress' or 'Completed'");
+    }
+    task_query.status = status->second;
+  }
 
-  nlohmann::json json;
+  std::string etag = utils::make_etag(db->get_change_tag());
+  if (utils::match_etag(req[http::field::if_none_match], etag))
+  {
+    return utils::create_not_modified_response(etag);
+  }
+
+  // open_stream declines a valid stream request only at the stream limit; buffering the whole list instead
+  // would cost the memory streaming exists to save, and exactly when the server is busy
+  if (is_stream_requested(query))
+  {
+    return utils::create_unavailable_response(stream_retry_after);
+  }
+
+  database::TaskPage page;
   try
   {
-    json = db->get_all_tasks();
+    page = db->get_tasks(task_query);
   }
   catch (const std::exception& e)
   {
     return utils::create_response(http::status::internal_server_error, true, e.what());
   }
 
-  return utils::create_json_response(http::status::ok, json);
+  std::string body;
+  database::append_json(body, page.tasks);
+
+  auto res = utils::create_raw_json_response(http::status::ok, std::move(body));
+  res.set(http::field::etag, etag);
+  if (page.next_cursor)
+  {
+    res.set(next_cursor_header, database::encode_cursor(page.next_cursor.value()));
+    res.set(http::field::access_control_expose_headers, next_cursor_header);
+  }
+  return res;
 }
 
-std::unique_ptr< handlers::RequestHandler > handlers::GetTasksHandler::create() const
+std::unique_ptr< handlers::ResponseStream > handlers::GetTasksHandler::open_stream(const http::request< http::string_body >& req,
+  const RouteParams&, const std::shared_ptr< database::Database >& db) const
 {
-  return std::make_unique< GetTasksHandler >();
+  auto query = utils::parse_query(req.target());
+
+  if (!is_stream_requested(query))
+  {
+    return nullptr;
+  }
+
+  std::optional< std::string > status;
+  if (auto status_param = query.find("status"); status_param != query.end())
+  {
+    if (utils::check_task_status(status_param->second))
+    {
+      return nullptr;
+    }
+    status = status_param->second;
+  }
+
+  std::string etag = utils::make_etag(db->get_change_tag());
+  if (utils::match_etag(req[http::field::if_none_match], etag))
+  {
+    return nullptr;
+  }
+
+  auto tasks = db->stream_tasks(status, TaskListStream::batch_size);
+  if (!tasks)
+  {
+    return nullptr;
+  }
+
+  http::response< http::empty_body > header(http::status::ok, req.version());
+  header.set(http::field::content_type, "application/json");
+  header.set(http::field::access_control_allow_origin, "*");
+  header.set(http::field::etag, etag);
+  header.keep_alive(req.keep_alive());
+
+  return std::make_unique< TaskListStream >(std::move(header), std::move(tasks));
 }
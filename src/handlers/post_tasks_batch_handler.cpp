@@ -0,0 +1,157 @@
+#include "post_tasks_batch_handler.hpp"
+#include "http_utils.hpp"
+#include "post_task_handler.hpp"
+
+namespace
+{
+  struct BatchTooLargeError
+  {};
+
+  http::response< http::string_body > create_too_large_response()
+  {
+    return utils::create_response(http::status::payload_too_large, true,
+      "Batch must contain at most " + std::to_string(handlers::PostTasksBatchHandler::max_batch_size) + " tasks");
+  }
+}
+
+http::response< http::string_body > handlers::PostTasksBatchHandler::handle_request(const http::request< http::string_body >& req,
+  const RouteParams&, const std::shared_ptr< database::Database >& db) const
+{
+  std::vector< nlohmann::json > items;
+  std::vector< std::optional< std::string > > parse_errors;
+
+  std::string_view body = req.body();
+  auto first = body.find_first_not_of(" \t\r\n");
+
+  if (first != std::string_view::npos && body[first] == '[')
+  {
+    // Elements of the top-level array are counted as they are parsed, so an oversized batch is rejected early
+    size_t count = 0;
+    auto count_items = [&count](int depth, nlohmann::json::parse_event_t event, nlohmann::json&)
+    {
+      bool item_end = event == nlohmann::json::parse_event_t::value || event == nlohmann::json::parse_event_t::object_end ||
+        event == nlohmann::json::parse_event_t::array_end;
+      if (depth == 1 && item_end && ++count > max_batch_size)
+      {
+        throw BatchTooLargeError();
+      }
+      return true;
+    };
+
+    nlohmann::json json;
+    try
+    {
+      json = nlohmann::json::parse(body, count_items);
+    }
+    catch (const nlohmann::json::parse_error&)
+    {
+      return utils::create_response(http::status::bad_request, true, "Wrong JSON format");
+    }
+    catch (const BatchTooLargeError&)
+    {
+      return create_too_large_response();
+    }
+
+    items.reserve(json.size());
+    for (auto& item : json)
+    {
+      items.push_back(std::move(item));
+      parse_errors.push_back(std::nullopt);
+    }
+  }
+  else
+  {
+    while (!body.empty())
+    {
+      auto line_end = std::min(body.find('\n'), body.size());
+      auto line = body.substr(0, line_end);
+      body.remove_prefix(std::min(line_end + 1, body.size()));
+
+      if (line.find_first_not_of(" \t\r") == std::string_view::npos)
+      {
+        continue;
+      }
+      if (items.size() == max_batch_size)
+      {
+        return create_too_large_response();
+      }
+
+      try
+      {
+        items.push_back(nlohmann::json::parse(line));
+        parse_errors.push_back(std::nullopt);
+      }
+      catch (const nlohmann::json::parse_error&)
+      {
+        items.push_back(nullptr);
+        parse_errors.push_back("Wrong JSON format");
+      }
+    }
+  }
+
+  if (items.empty())
+  {
+    return utils::create_response(http::status::bad_request, true, "No tasks");
+  }
+
+  std::vector< database::Task > tasks;
+  std::vector< size_t > positions;
+  nlohmann::json errors = nlohmann::json::array();
+
+  tasks.reserve(items.size());
+  positions.reserve(items.size());
+  for (size_t i = 0; i != items.size(); ++i)
+  {
+    std::optional< std::string > error = parse_errors[i];
+
+    database::Task task;
+    if (!error)
+    {
+      try
+      {
+        if (!items[i].is_object())
+        {
+          throw std::invalid_argument("Wrong JSON format");
+        }
+        database::from_json(items[i], task);
+        error = PostTaskHandler::validate(task);
+      }
+      catch (const std::exception& e)
+      {
+        error = e.what();
+      }
+    }
+
+    if (error)
+    {
+      errors.push_back({ { "index", i }, { "message", error.value() } });
+      continue;
+    }
+
+    tasks.push_back(std::move(task));
+    positions.push_back(i);
+  }
+
+  std::vector< int > ids;
+  try
+  {
+    ids = db->create_tasks(tasks);
+  }
+  catch (const std::exception& e)
+  {
+    return utils::create_response(http::status::internal_server_error, true, e.what());
+  }
+
+  nlohmann::json created = nlohmann::json::array();
+  for (size_t i = 0; i != ids.size(); ++i)
+  {
+    created.push_back({ { "index", positions[i] }, { "id", ids[i] } });
+  }
+
+  nlohmann::json json = {
+    { "created", std::move(created) },
+    { "errors", std::move(errors) }
+  };
+
+  return utils::create_json_response(ids.empty() ? http::status::bad_request : http::status::created, json);
+}
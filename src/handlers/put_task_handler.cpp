@@ -1,25 +1,16 @@
 #include "put_task_handler.hpp"
 #include "http_utils.hpp"
 
-bool handlers::PutTaskHandler::can_handle(const http::request< http::string_body >& req) const
-{
-  auto params = utils::parse_parameters(req.target());
-  return req.method() == http::verb::put && params.size() == 2 && params[1] == "task";
-}
-
 http::response< http::string_body > handlers::PutTaskHandler::handle_request(const http::request< http::string_body >& req,
-  std::shared_ptr< database::Database > db)
+  const RouteParams&, const std::shared_ptr< database::Database >& db) const
 {
-  std::vector< std::string > params = utils::parse_parameters(req.target());
-
   database::Task task;
 
   try
   {
-    nlohmann::json json = nlohmann::json::parse(req.body());
-    database::from_json(json, task);
+    database::parse_task(req.body(), task);
   }
-  catch (const nlohmann::json::parse_error&)
+  catch (const database::JsonFormatError&)
   {
     return utils::create_response(http::status::bad_request, true, "Wrong JSON format");
   }
@@ -37,19 +28,46 @@ http::response< http::string_body > handlers::PutTaskHandler::handle_request(con
     return utils::create_response(http::status::bad_request, true, "Status must be 'Todo', 'In progress' or 'Completed'");
   }
 
+  std::vector< int > versions;
+  if (task.get_version())
+  {
+    versions.push_back(task.get_version().value());
+  }
+
+  auto if_match = req[http::field::if_match];
+  if (!if_match.empty() && if_match != "*")
+  {
+    auto tags = utils::parse_if_match(if_match);
+    if (!tags)
+    {
+      return utils::create_response(http::status::bad_request, true, "Wrong If-Match");
+    }
+    if (tags->empty())
+    {
+      return utils::create_response(http::status::precondition_failed, true, "If-Match has no strong entity tag");
+    }
+    versions = std::move(tags.value());
+  }
+
+  int version = 0;
   try
   {
-    db->update_task(task);
+    version = db->update_task(task, versions);
+  }
+  catch (const database::TaskNotFoundError& e)
+  {
+    return utils::create_response(http::status::not_found, true, e.what());
+  }
+  catch (const database::VersionConflictError& e)
+  {
+    return utils::create_response(http::status::precondition_failed, true, e.what());
   }
   catch (const std::exception& e)
   {
     return utils::create_response(http::status::internal_server_error, true, e.what());
   }
 
-  return utils::create_response(http::status::accepted, false, "Updated");
-}
-
-std::unique_ptr< handlers::RequestHandler > handlers::PutTaskHandler::create() const
-{
-  return std::make_unique< PutTaskHandler >();
+  auto res = utils::create_response(http::status::accepted, false, "Updated");
+  res.set(http::field::etag, utils::make_version_tag(version));
+  return res;
 }
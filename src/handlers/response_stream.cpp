@@ -0,0 +1,34 @@
+#include "response_stream.hpp"
+
+handlers::ResponseStream::ResponseStream(http::response< http::empty_body > header):
+  header_(std::move(header))
+{
+  header_.chunked(true);
+}
+
+http::response< http::empty_body >& handlers::ResponseStream::get_header()
+{
+  return header_;
+}
+
+handlers::CompressedResponseStream::CompressedResponseStream(std::unique_ptr< ResponseStream > stream,
+  utils::ContentEncoding encoding, int level):
+  ResponseStream(stream->get_header()),
+  stream_(std::move(stream)),
+  compressor_(encoding, level),
+  raw_buffer_()
+{
+  get_header().set(http::field::content_encoding, utils::encoding_to_string(encoding));
+  if (get_header().count(http::field::etag))
+  {
+    get_header().set(http::field::etag, utils::encode_etag(get_header()[http::field::etag], encoding));
+  }
+}
+
+bool handlers::CompressedResponseStream::next_chunk(std::string& buffer)
+{
+  raw_buffer_.clear();
+  bool has_more = stream_->next_chunk(raw_buffer_);
+  compressor_.compress(raw_buffer_, buffer, !has_more);
+  return has_more;
+}
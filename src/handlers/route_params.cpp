@@ -0,0 +1,51 @@
+#include "route_params.hpp"
+#include <charconv>
+
+handlers::RouteParams::RouteParams():
+  params_(),
+  size_(0)
+{}
+
+bool handlers::RouteParams::add(beast::string_view name, beast::string_view value)
+{
+  if (size_ == max_params)
+  {
+    return false;
+  }
+  params_[size_++] = { name, value };
+  return true;
+}
+
+std::optional< beast::string_view > handlers::RouteParams::get(beast::string_view name) const
+{
+  for (size_t i = 0; i != size_; ++i)
+  {
+    if (params_[i].first == name)
+    {
+      return params_[i].second;
+    }
+  }
+  return std::nullopt;
+}
+
+std::optional< int > handlers::RouteParams::get_int(beast::string_view name) const
+{
+  auto value = get(name);
+  if (!value || value->empty())
+  {
+    return std::nullopt;
+  }
+
+  int result = 0;
+  auto [ptr, ec] = std::from_chars(value->data(), value->data() + value->size(), result);
+  if (ec != std::errc() || ptr != value->data() + value->size())
+  {
+    return std::nullopt;
+  }
+  return result;
+}
+
+size_t handlers::RouteParams::size() const
+{
+  return size_;
+}
@@ -0,0 +1,169 @@
+#include "router.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include "delete_task_handler.hpp"
+#include "get_task_handler.hpp"
+#include "get_tasks_handler.hpp"
+#include "post_task_handler.hpp"
+#include "post_tasks_batch_handler.hpp"
+#include "put_task_handler.hpp"
+
+handlers::Router::Router():
+  root_(std::make_unique< Node >()),
+  routes_()
+{}
+
+void handlers::Router::add(http::verb method, beast::string_view pattern, std::unique_ptr< RequestHandler > handler)
+{
+  std::array< beast::string_view, max_segments + 1 > segments;
+  size_t count = split_path(pattern, segments);
+  if (count > max_segments)
+  {
+    throw std::invalid_argument("Wrong route pattern: " + std::string(pattern));
+  }
+
+  Node* node = root_.get();
+  for (size_t i = 0; i != count; ++i)
+  {
+    beast::string_view segment = segments[i];
+    if (segment.size() > 2 && segment.front() == '{' && segment.back() == '}')
+    {
+      std::string name(segment.substr(1, segment.size() - 2));
+      if (!node->param_child)
+      {
+        node->param_child = std::make_unique< Node >();
+        node->param_child->param_name = name;
+      }
+      else if (node->param_child->param_name != name)
+      {
+        throw std::invalid_argument("Conflicting route parameter: " + std::string(pattern));
+      }
+      node = node->param_child.get();
+      continue;
+    }
+
+    auto child = std::find_if(node->children.begin(), node->children.end(), [segment](const auto& child)
+    {
+      return beast::string_view(child.first) == segment;
+    });
+    if (child == node->children.end())
+    {
+      node->children.emplace_back(std::string(segment), std::make_unique< Node >());
+      child = std::prev(node->children.end());
+    }
+    node = child->second.get();
+  }
+
+  for (size_t i = 0; i != node->handlers.size(); ++i)
+  {
+    if (node->handlers[i].first == method)
+    {
+      throw std::invalid_argument("Duplicate route: " + std::string(pattern));
+    }
+  }
+
+  node->handlers.emplace_back(method, routes_.size());
+  routes_.push_back({ method, std::string(pattern), std::move(handler) });
+}
+
+std::optional< handlers::Router::Match > handlers::Router::match(http::verb method, beast::string_view target) const
+{
+  std::array< beast::string_view, max_segments + 1 > segments;
+  size_t count = split_path(target, segments);
+  if (count > max_segments)
+  {
+    return std::nullopt;
+  }
+
+  Match match;
+  const Node* node = root_.get();
+  for (size_t i = 0; i != count; ++i)
+  {
+    const Node* next = nullptr;
+    for (size_t j = 0; j != node->children.size(); ++j)
+    {
+      if (beast::string_view(node->children[j].first) == segments[i])
+      {
+        next = node->children[j].second.get();
+        break;
+      }
+    }
+
+    if (!next && node->param_child)
+    {
+      next = node->param_child.get();
+      if (!match.params.add(next->param_name, segments[i]))
+      {
+        return std::nullopt;
+      }
+    }
+
+    if (!next)
+    {
+      return std::nullopt;
+    }
+    node = next;
+  }
+
+  for (size_t i = 0; i != node->handlers.size(); ++i)
+  {
+    if (node->handlers[i].first == method)
+    {
+      match.route = node->handlers[i].second;
+      match.handler = routes_[match.route].handler.get();
+      return match;
+    }
+  }
+  return std::nullopt;
+}
+
+std::vector< std::pair< http::verb, std::string > > handlers::Router::get_routes() const
+{
+  std::vector< std::pair< http::verb, std::string > > routes;
+  routes.reserve(routes_.size());
+  for (size_t i = 0; i != routes_.size(); ++i)
+  {
+    routes.emplace_back(routes_[i].method, routes_[i].pattern);
+  }
+  return routes;
+}
+
+std::string_view handlers::Router::get_pattern(size_t route) const
+{
+  return route < routes_.size() ? std::string_view(routes_[route].pattern) : std::string_view();
+}
+
+handlers::Router handlers::Router::create_default()
+{
+  Router router;
+  router.add(http::verb::get, "/tasks", std::make_unique< GetTasksHandler >());
+  router.add(http::verb::post, "/tasks/batch", std::make_unique< PostTasksBatchHandler >());
+  router.add(http::verb::post, "/task", std::make_unique< PostTaskHandler >());
+  router.add(http::verb::put, "/task", std::make_unique< PutTaskHandler >());
+  router.add(http::verb::get, "/task/{id}", std::make_unique< GetTaskHandler >());
+  router.add(http::verb::delete_, "/task/{id}", std::make_unique< DeleteTaskHandler >());
+  return router;
+}
+
+size_t handlers::Router::split_path(beast::string_view target, std::array< beast::string_view, max_segments + 1 >& segments)
+{
+  beast::string_view path = target.substr(0, target.find('?'));
+  if (path.empty() || path.front() != '/')
+  {
+    return max_segments + 1;
+  }
+  path.remove_prefix(1);
+
+  size_t count = 0;
+  while (count != segments.size())
+  {
+    auto end = path.find('/');
+    segments[count++] = path.substr(0, end);
+    if (end == beast::string_view::npos)
+    {
+      return count;
+    }
+    path.remove_prefix(end + 1);
+  }
+  return max_segments + 1;
+}
@@ -1,5 +1,36 @@
 #include "logger.hpp"
 
+logger::Logger::Logger():
+  buffer_(std::make_unique< Record[] >(buffer_capacity)),
+  enqueue_pos_(0),
+  dequeue_pos_(0),
+  published_(0),
+  written_(0),
+  dropped_(0),
+  policy_(OverflowPolicy::DROP),
+  min_level_(LogLevel::INFO),
+  stopping_(false)
+{
+  for (size_t i = 0; i != buffer_capacity; ++i)
+  {
+    buffer_[i].sequence.store(i, std::memory_order_relaxed);
+  }
+
+  writer_ = std::thread(&Logger::run, this);
+}
+
+logger::Logger::~Logger()
+{
+  stopping_.store(true, std::memory_order_release);
+  published_.fetch_add(1, std::memory_order_release);
+  published_.notify_one();
+
+  if (writer_.joinable())
+  {
+    writer_.join();
+  }
+}
+
 logger::Logger& logger::Logger::get_instance()
 {
   static Logger logger;
@@ -8,12 +39,157 @@ logger::Logger& logger::Logger::get_instance()
 
 void logger::Logger::log(LogLevel level, const std::string& message)
 {
-  std::lock_guard< std::mutex > lock(log_mutex_);
+  push(level, std::string(message));
+}
+
+void logger::Logger::log(LogLevel level, std::string&& message)
+{
+  push(level, std::move(message));
+}
+
+void logger::Logger::flush()
+{
+  uint64_t target = enqueue_pos_.load(std::memory_order_acquire);
+  uint64_t written = written_.load(std::memory_order_acquire);
+  while (written < target && !stopping_.load(std::memory_order_acquire))
+  {
+    written_.wait(written, std::memory_order_acquire);
+    written = written_.load(std::memory_order_acquire);
+  }
+}
+
+void logger::Logger::set_min_level(LogLevel level)
+{
+  min_level_.store(level, std::memory_order_relaxed);
+}
+
+logger::LogLevel logger::Logger::get_min_level() const
+{
+  return min_level_.load(std::memory_order_relaxed);
+}
 
+void logger::Logger::set_overflow_policy(OverflowPolicy policy)
+{
+  policy_.store(policy, std::memory_order_relaxed);
+}
+
+uint64_t logger::Logger::get_dropped() const
+{
+  return dropped_.load(std::memory_order_relaxed);
+}
+
+void logger::Logger::push(LogLevel level, std::string&& message)
+{
   auto now = std::chrono::system_clock::now();
-  auto now_ms = std::chrono::floor< std::chrono::milliseconds >(now);
-  std::string formatted_time = std::format("{:%Y-%m-%d %H:%M:%S}", now_ms);
-  std::cout << std::format("[{}] [{}]: {}\n", formatted_time, level_to_string(level), message);
+
+  while (!try_push(level, now, message))
+  {
+    if (policy_.load(std::memory_order_relaxed) == OverflowPolicy::DROP)
+    {
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    std::this_thread::yield();
+  }
+
+  published_.fetch_add(1, std::memory_order_release);
+  published_.notify_one();
+}
+
+bool logger::Logger::try_push(LogLevel level, std::chrono::system_clock::time_point time, std::string& message)
+{
+  size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+  for (;;)
+  {
+    Record& record = buffer_[pos & (buffer_capacity - 1)];
+    size_t sequence = record.sequence.load(std::memory_order_acquire);
+    auto diff = static_cast< std::ptrdiff_t >(sequence) - static_cast< std::ptrdiff_t >(pos);
+
+    if (diff == 0)
+    {
+      if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+      {
+        record.level = level;
+        record.time = time;
+        record.message.swap(message);
+        record.sequence.store(pos + 1, std::memory_order_release);
+        return true;
+      }
+    }
+    else if (diff < 0)
+    {
+      return false;
+    }
+    else
+    {
+      pos = enqueue_pos_.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+void logger::Logger::run()
+{
+  std::string batch;
+  uint64_t reported_dropped = 0;
+
+  for (;;)
+  {
+    uint64_t published = published_.load(std::memory_order_acquire);
+
+    batch.clear();
+    uint64_t count = drain(batch);
+
+    uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+    if (dropped != reported_dropped)
+    {
+      std::format_to(std::back_inserter(batch), "[{:%Y-%m-%d %H:%M:%S}] [{}]: Dropped {} log messages\n",
+        std::chrono::floor< std::chrono::milliseconds >(std::chrono::system_clock::now()),
+        level_to_string(LogLevel::WARNING), dropped - reported_dropped);
+      reported_dropped = dropped;
+    }
+
+    if (!batch.empty())
+    {
+      std::cout.write(batch.data(), static_cast< std::streamsize >(batch.size()));
+      std::cout.flush();
+    }
+
+    if (count != 0)
+    {
+      written_.fetch_add(count, std::memory_order_release);
+      written_.notify_all();
+      continue;
+    }
+
+    if (stopping_.load(std::memory_order_acquire))
+    {
+      break;
+    }
+    published_.wait(published, std::memory_order_acquire);
+  }
+
+  written_.notify_all();
+}
+
+uint64_t logger::Logger::drain(std::string& batch)
+{
+  uint64_t count = 0;
+  for (;;)
+  {
+    Record& record = buffer_[dequeue_pos_ & (buffer_capacity - 1)];
+    if (record.sequence.load(std::memory_order_acquire) != dequeue_pos_ + 1)
+    {
+      return count;
+    }
+
+    std::format_to(std::back_inserter(batch), "[{:%Y-%m-%d %H:%M:%S}] [{}]: {}\n",
+      std::chrono::floor< std::chrono::milliseconds >(record.time), level_to_string(record.level), record.message);
+    record.message.clear();
+
+    record.sequence.store(dequeue_pos_ + buffer_capacity, std::memory_order_release);
+    ++dequeue_pos_;
+    ++count;
+  }
 }
 
 constexpr std::string_view logger::Logger::level_to_string(LogLevel level)
@@ -34,3 +210,28 @@ constexpr std::string_view logger::Logger::level_to_string(LogLevel level)
       return "UNKNOWN";
   }
 }
+
+std::optional< logger::LogLevel > logger::string_to_level(std::string_view level)
+{
+  if (level == "DEBUG")
+  {
+    return LogLevel::DEBUG;
+  }
+  else if (level == "INFO")
+  {
+    return LogLevel::INFO;
+  }
+  else if (level == "WARNING")
+  {
+    return LogLevel::WARNING;
+  }
+  else if (level == "ERROR")
+  {
+    return LogLevel::ERROR;
+  }
+  else if (level == "CRITICAL")
+  {
+    return LogLevel::CRITICAL;
+  }
+  return std::nullopt;
+}
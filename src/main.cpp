@@ -1,11 +1,26 @@
 #include "server.hpp"
 #include <iostream>
 #include <cstdlib>
+#include <stdexcept>
 
 int main()
 {
   try
   {
+    if (std::getenv("LOG_LEVEL"))
+    {
+      auto level = logger::string_to_level(std::getenv("LOG_LEVEL"));
+      if (!level)
+      {
+        throw std::invalid_argument(std::format("Unknown LOG_LEVEL: {}", std::getenv("LOG_LEVEL")));
+      }
+      logger::Logger::get_instance().set_min_level(*level);
+    }
+    if (std::getenv("LOG_OVERFLOW_POLICY") && std::string(std::getenv("LOG_OVERFLOW_POLICY")) == "block")
+    {
+      logger::Logger::get_instance().set_overflow_policy(logger::OverflowPolicy::BLOCK);
+    }
+
     std::string db_host = std::getenv("DB_HOST") ? std::getenv("DB_HOST") : "localhost";
     std::string db_port = std::getenv("DB_PORT") ? std::getenv("DB_PORT") : "5432";
     std::string db_name = std::getenv("DB_NAME") ? std::getenv("DB_NAME") : "todoapp";
@@ -15,17 +30,55 @@ int main()
     unsigned short server_port = std::getenv("SERVER_PORT") ? std::atoi(std::getenv("SERVER_PORT")) : 9000;
     size_t threads_num = std::getenv("THREADS_NUM") ? std::stoull(std::getenv("THREADS_NUM")) : 1;
 
+    database::DatabaseConfig db_config;
+    db_config.pool.min_size = std::getenv("DB_POOL_MIN_SIZE") ? std::stoull(std::getenv("DB_POOL_MIN_SIZE")) : 1;
+    db_config.pool.max_size = std::getenv("DB_POOL_MAX_SIZE") ? std::stoull(std::getenv("DB_POOL_MAX_SIZE")) : threads_num;
+    db_config.pool.checkout_timeout = std::chrono::milliseconds(std::getenv("DB_POOL_TIMEOUT_MS") ?
+      std::stoll(std::getenv("DB_POOL_TIMEOUT_MS")) : 5000);
+    db_config.cache_capacity = std::getenv("TASK_CACHE_CAPACITY") ? std::stoull(std::getenv("TASK_CACHE_CAPACITY")) : 10000;
+    db_config.group_commit.enabled = std::getenv("DB_GROUP_COMMIT") && std::string(std::getenv("DB_GROUP_COMMIT")) == "1";
+    db_config.group_commit.window = std::chrono::microseconds(std::getenv("DB_GROUP_COMMIT_WINDOW_US") ?
+      std::stoll(std::getenv("DB_GROUP_COMMIT_WINDOW_US")) : 1000);
+    db_config.group_commit.max_batch_size = std::getenv("DB_GROUP_COMMIT_MAX_BATCH") ?
+      std::stoull(std::getenv("DB_GROUP_COMMIT_MAX_BATCH")) : 64;
+    db_config.max_streams = std::getenv("DB_MAX_STREAMS") ? std::stoull(std::getenv("DB_MAX_STREAMS")) : 0;
+
     std::string connection_string = "host=" + db_host +
       " port=" + db_port +
       " dbname=" + db_name +
       " user=" + db_user +
       " password=" + db_password;
 
-    auto db = std::make_shared< database::Database >(connection_string);
+    auto db = std::make_shared< database::Database >(connection_string, db_config);
 
     db->initialize_database();
 
-    server::Server server(server_host, server_port, threads_num, db);
+    server::ServerConfig server_config;
+    server_config.db_threads_num = std::getenv("DB_THREADS") ? std::stoull(std::getenv("DB_THREADS")) : db_config.pool.max_size;
+    server_config.reuse_port = std::getenv("SERVER_REUSE_PORT") && std::string(std::getenv("SERVER_REUSE_PORT")) == "1";
+    server_config.session_mode = std::getenv("SERVER_SESSION_MODE") && std::string(std::getenv("SERVER_SESSION_MODE")) == "coroutine" ?
+      server::SessionMode::COROUTINE : server::SessionMode::CALLBACK;
+    server_config.admission.max_sessions = std::getenv("ADMISSION_MAX_SESSIONS") ? std::stoull(std::getenv("ADMISSION_MAX_SESSIONS")) : 0;
+    server_config.admission.max_inflight = std::getenv("ADMISSION_MAX_INFLIGHT") ? std::stoull(std::getenv("ADMISSION_MAX_INFLIGHT")) : 0;
+    server_config.admission.target_delay = std::chrono::milliseconds(std::getenv("ADMISSION_TARGET_DELAY_MS") ?
+      std::stoll(std::getenv("ADMISSION_TARGET_DELAY_MS")) : 100);
+    server_config.admission.interval = std::chrono::milliseconds(std::getenv("ADMISSION_INTERVAL_MS") ?
+      std::stoll(std::getenv("ADMISSION_INTERVAL_MS")) : 1000);
+    server_config.admission.retry_after = std::chrono::seconds(std::getenv("ADMISSION_RETRY_AFTER") ?
+      std::stoll(std::getenv("ADMISSION_RETRY_AFTER")) : 1);
+    server_config.metrics = !std::getenv("SERVER_METRICS") || std::string(std::getenv("SERVER_METRICS")) != "0";
+    server_config.tracing.server_timing = std::getenv("SERVER_TIMING") && std::string(std::getenv("SERVER_TIMING")) == "1";
+    server_config.tracing.sample_ratio = std::getenv("TRACE_SAMPLE_RATIO") ? std::stod(std::getenv("TRACE_SAMPLE_RATIO")) : 0.0;
+    server_config.tracing.output_path = std::getenv("TRACE_FILE") ? std::getenv("TRACE_FILE") : "";
+    server_config.header_limit = std::getenv("HTTP_HEADER_LIMIT") ? std::stoul(std::getenv("HTTP_HEADER_LIMIT")) : 8 * 1024;
+    server_config.body_limit = std::getenv("HTTP_BODY_LIMIT") ? std::stoull(std::getenv("HTTP_BODY_LIMIT")) : 8 * 1024 * 1024;
+    server_config.pipeline_limit = std::getenv("HTTP_PIPELINE_LIMIT") ? std::stoull(std::getenv("HTTP_PIPELINE_LIMIT")) : 16;
+    server_config.compression.enabled = !std::getenv("HTTP_COMPRESSION") || std::string(std::getenv("HTTP_COMPRESSION")) != "0";
+    server_config.compression.threshold = std::getenv("HTTP_COMPRESSION_THRESHOLD") ?
+      std::stoull(std::getenv("HTTP_COMPRESSION_THRESHOLD")) : 1024;
+    server_config.compression.level = std::getenv("HTTP_COMPRESSION_LEVEL") ? std::stoi(std::getenv("HTTP_COMPRESSION_LEVEL")) : 6;
+
+    server::Server server(server_host, server_port, threads_num, db, server_config);
     server.start();
 
     std::string line;
@@ -38,11 +91,12 @@ int main()
     }
 
     server.stop();
+    logger::Logger::get_instance().flush();
   }
   catch (const std::exception& e)
   {
-    std::string error = e.what();
-    LOG(logger::LogLevel::CRITICAL, "App error: " + error + '\n');
+    LOG(logger::LogLevel::CRITICAL, "App error: {}", e.what());
+    logger::Logger::get_instance().flush();
     return 1;
   }
 
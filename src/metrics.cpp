@@ -0,0 +1,324 @@
+#include "metrics.hpp"
+#include <algorithm>
+#include <bit>
+#include <exception>
+#include <format>
+#include <iterator>
+#include <limits>
+
+namespace
+{
+  void increment(std::atomic< uint64_t >& counter, uint64_t value = 1)
+  {
+    // Every cell has a single writer, so a plain load and store is enough and avoids a locked RMW.
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+  }
+
+  size_t status_class(unsigned status)
+  {
+    if (status < 100 || status >= 600)
+    {
+      return metrics::status_classes - 1;
+    }
+    return status / 100 - 1;
+  }
+
+  void write_histogram(std::string& out, std::string_view name, std::string_view labels,
+    const metrics::HistogramSnapshot& histogram)
+  {
+    std::string_view separator = labels.empty() ? "" : ",";
+    uint64_t cumulative = 0;
+    for (size_t i = 0; i != metrics::Histogram::bucket_count - 1; ++i)
+    {
+      cumulative += histogram.buckets[i];
+      std::format_to(std::back_inserter(out), "{}_bucket{{{}{}le=\"{}\"}} {}\n",
+        name, labels, separator, metrics::Histogram::bucket_bound(i), cumulative);
+    }
+    std::format_to(std::back_inserter(out), "{}_bucket{{{}{}le=\"+Inf\"}} {}\n", name, labels, separator, histogram.count);
+    std::format_to(std::back_inserter(out), "{}_sum{{{}}} {}\n", name, labels,
+      std::chrono::duration< double >(histogram.sum).count());
+    std::format_to(std::back_inserter(out), "{}_count{{{}}} {}\n", name, labels, histogram.count);
+  }
+}
+
+std::string_view metrics::operation_to_string(DbOperation operation)
+{
+  switch (operation)
+  {
+    case DbOperation::CREATE_TASK:
+      return "create_task";
+    case DbOperation::CREATE_TASKS:
+      return "create_tasks";
+    case DbOperation::GET_ALL_TASKS:
+      return "get_all_tasks";
+    case DbOperation::GET_TASKS:
+      return "get_tasks";
+    case DbOperation::STREAM_TASKS:
+      return "stream_tasks";
+    case DbOperation::FETCH_TASKS:
+      return "fetch_tasks";
+    case DbOperation::GET_TASK_BY_ID:
+      return "get_task_by_id";
+    case DbOperation::UPDATE_TASK:
+      return "update_task";
+    case DbOperation::DELETE_TASK:
+      return "delete_task";
+    default:
+      return "unknown";
+  }
+}
+
+size_t metrics::Histogram::bucket_index(std::chrono::nanoseconds value)
+{
+  // Bounds are inclusive like Prometheus "le": a value exactly at a bound belongs to that bucket
+  uint64_t us = value.count() > 0 ? (static_cast< uint64_t >(value.count()) + 999) / 1000 : 0;
+  if (us <= min_bound_us)
+  {
+    return 0;
+  }
+
+  uint64_t below = us - 1;
+  size_t octave = std::bit_width(below) - 1;
+  size_t first_octave = std::bit_width(min_bound_us) - 1;
+  if (octave >= first_octave + octaves)
+  {
+    return bucket_count - 1;
+  }
+
+  size_t sub_shift = octave - (std::bit_width(sub_buckets) - 1);
+  size_t sub_bucket = (below >> sub_shift) & (sub_buckets - 1);
+  return 1 + sub_buckets * (octave - first_octave) + sub_bucket;
+}
+
+double metrics::Histogram::bucket_bound(size_t index)
+{
+  if (index >= bucket_count - 1)
+  {
+    return std::numeric_limits< double >::infinity();
+  }
+  if (index == 0)
+  {
+    return static_cast< double >(min_bound_us) / 1e6;
+  }
+
+  size_t octave = (index - 1) / sub_buckets + std::bit_width(min_bound_us) - 1;
+  size_t sub_bucket = (index - 1) % sub_buckets;
+  size_t sub_shift = octave - (std::bit_width(sub_buckets) - 1);
+  uint64_t bound = (uint64_t(1) << octave) + ((sub_bucket + 1) << sub_shift);
+  return static_cast< double >(bound) / 1e6;
+}
+
+void metrics::Histogram::record(std::chrono::nanoseconds value)
+{
+  increment(buckets_[bucket_index(value)]);
+  increment(sum_, value.count() > 0 ? static_cast< uint64_t >(value.count()) : 0);
+}
+
+void metrics::Histogram::add_to(HistogramSnapshot& snapshot) const
+{
+  for (size_t i = 0; i != bucket_count; ++i)
+  {
+    uint64_t count = buckets_[i].load(std::memory_order_relaxed);
+    snapshot.buckets[i] += count;
+    snapshot.count += count;
+  }
+  snapshot.sum += std::chrono::nanoseconds(sum_.load(std::memory_order_relaxed));
+}
+
+metrics::Registry& metrics::Registry::get_instance()
+{
+  static Registry registry;
+  return registry;
+}
+
+void metrics::Registry::set_routes(std::vector< RouteLabel > routes)
+{
+  std::lock_guard< std::mutex > lock(mutex_);
+  routes_ = std::move(routes);
+}
+
+void metrics::Registry::record_request(size_t route, unsigned status, std::chrono::nanoseconds latency)
+{
+  ThreadCells& cells = local();
+  route = std::min(route, unmatched_route);
+  increment(cells.requests[route][status_class(status)]);
+  cells.request_latency[route].record(latency);
+}
+
+void metrics::Registry::record_bytes_received(uint64_t bytes)
+{
+  increment(local().bytes_received, bytes);
+}
+
+void metrics::Registry::record_bytes_sent(uint64_t bytes)
+{
+  increment(local().bytes_sent, bytes);
+}
+
+void metrics::Registry::session_opened()
+{
+  increment(local().sessions_opened);
+}
+
+void metrics::Registry::session_closed()
+{
+  increment(local().sessions_closed);
+}
+
+void metrics::Registry::record_db_query(DbOperation operation, std::chrono::nanoseconds latency, bool failed)
+{
+  ThreadCells& cells = local();
+  size_t index = static_cast< size_t >(operation);
+  cells.db_latency[index].record(latency);
+  if (failed)
+  {
+    increment(cells.db_errors[index]);
+  }
+}
+
+metrics::Snapshot metrics::Registry::collect() const
+{
+  Snapshot snapshot;
+  uint64_t sessions_opened = 0;
+  uint64_t sessions_closed = 0;
+
+  std::lock_guard< std::mutex > lock(mutex_);
+  snapshot.routes = routes_;
+  for (const auto& cells: cells_)
+  {
+    for (size_t route = 0; route != route_slots; ++route)
+    {
+      for (size_t status = 0; status != status_classes; ++status)
+      {
+        snapshot.requests[route][status] += cells->requests[route][status].load(std::memory_order_relaxed);
+      }
+      cells->request_latency[route].add_to(snapshot.request_latency[route]);
+    }
+
+    for (size_t operation = 0; operation != db_operations; ++operation)
+    {
+      cells->db_latency[operation].add_to(snapshot.db_latency[operation]);
+      snapshot.db_errors[operation] += cells->db_errors[operation].load(std::memory_order_relaxed);
+    }
+
+    snapshot.bytes_received += cells->bytes_received.load(std::memory_order_relaxed);
+    snapshot.bytes_sent += cells->bytes_sent.load(std::memory_order_relaxed);
+    sessions_opened += cells->sessions_opened.load(std::memory_order_relaxed);
+    sessions_closed += cells->sessions_closed.load(std::memory_order_relaxed);
+  }
+
+  snapshot.active_sessions = static_cast< int64_t >(sessions_opened) - static_cast< int64_t >(sessions_closed);
+  return snapshot;
+}
+
+void metrics::Registry::write_prometheus(std::string& out) const
+{
+  Snapshot snapshot = collect();
+
+  auto route_labels = [&snapshot](size_t route)
+  {
+    if (route < snapshot.routes.size() && route < max_routes)
+    {
+      return std::format("method=\"{}\",route=\"{}\"", snapshot.routes[route].method, snapshot.routes[route].pattern);
+    }
+    return std::string("method=\"\",route=\"unmatched\"");
+  };
+  size_t routes_num = std::min(snapshot.routes.size(), max_routes);
+
+  out += "# HELP todo_http_requests_total HTTP responses by route and status class.\n";
+  out += "# TYPE todo_http_requests_total counter\n";
+  for (size_t route = 0; route != routes_num; ++route)
+  {
+    for (size_t status = 0; status != status_classes; ++status)
+    {
+      std::format_to(std::back_inserter(out), "todo_http_requests_total{{{},code=\"{}xx\"}} {}\n",
+        route_labels(route), status + 1, snapshot.requests[route][status]);
+    }
+  }
+  for (size_t status = 0; status != status_classes; ++status)
+  {
+    std::format_to(std::back_inserter(out), "todo_http_requests_total{{{},code=\"{}xx\"}} {}\n",
+      route_labels(unmatched_route), status + 1, snapshot.requests[unmatched_route][status]);
+  }
+
+  out += "# HELP todo_http_request_duration_seconds Time from reading a request to writing its response.\n";
+  out += "# TYPE todo_http_request_duration_seconds histogram\n";
+  for (size_t route = 0; route != routes_num; ++route)
+  {
+    write_histogram(out, "todo_http_request_duration_seconds", route_labels(route), snapshot.request_latency[route]);
+  }
+  write_histogram(out, "todo_http_request_duration_seconds", route_labels(unmatched_route),
+    snapshot.request_latency[unmatched_route]);
+
+  out += "# HELP todo_http_received_bytes_total Bytes read from client connections.\n";
+  out += "# TYPE todo_http_received_bytes_total counter\n";
+  std::format_to(std::back_inserter(out), "todo_http_received_bytes_total {}\n", snapshot.bytes_received);
+  out += "# HELP todo_http_sent_bytes_total Bytes written to client connections.\n";
+  out += "# TYPE todo_http_sent_bytes_total counter\n";
+  std::format_to(std::back_inserter(out), "todo_http_sent_bytes_total {}\n", snapshot.bytes_sent);
+  out += "# HELP todo_http_active_sessions Open client sessions.\n";
+  out += "# TYPE todo_http_active_sessions gauge\n";
+  std::format_to(std::back_inserter(out), "todo_http_active_sessions {}\n", snapshot.active_sessions);
+
+  out += "# HELP todo_db_query_duration_seconds Database call latency by operation.\n";
+  out += "# TYPE todo_db_query_duration_seconds histogram\n";
+  for (size_t operation = 0; operation != db_operations; ++operation)
+  {
+    write_histogram(out, "todo_db_query_duration_seconds",
+      std::format("operation=\"{}\"", operation_to_string(static_cast< DbOperation >(operation))),
+      snapshot.db_latency[operation]);
+  }
+  out += "# HELP todo_db_query_errors_total Database calls that threw, by operation.\n";
+  out += "# TYPE todo_db_query_errors_total counter\n";
+  for (size_t operation = 0; operation != db_operations; ++operation)
+  {
+    std::format_to(std::back_inserter(out), "todo_db_query_errors_total{{operation=\"{}\"}} {}\n",
+      operation_to_string(static_cast< DbOperation >(operation)), snapshot.db_errors[operation]);
+  }
+}
+
+metrics::Registry::Lease::Lease(Registry& registry):
+  registry_(registry),
+  cells_(nullptr)
+{
+  std::lock_guard< std::mutex > lock(registry_.mutex_);
+  if (!registry_.free_cells_.empty())
+  {
+    cells_ = registry_.free_cells_.back();
+    registry_.free_cells_.pop_back();
+  }
+  else
+  {
+    registry_.cells_.push_back(std::make_unique< ThreadCells >());
+    cells_ = registry_.cells_.back().get();
+  }
+}
+
+metrics::Registry::Lease::~Lease()
+{
+  std::lock_guard< std::mutex > lock(registry_.mutex_);
+  registry_.free_cells_.push_back(cells_);
+}
+
+metrics::Registry::ThreadCells& metrics::Registry::Lease::get()
+{
+  return *cells_;
+}
+
+metrics::Registry::ThreadCells& metrics::Registry::local()
+{
+  thread_local Lease lease(*this);
+  return lease.get();
+}
+
+metrics::DbTimer::DbTimer(DbOperation operation):
+  operation_(operation),
+  start_(std::chrono::steady_clock::now()),
+  exceptions_(std::uncaught_exceptions())
+{}
+
+metrics::DbTimer::~DbTimer()
+{
+  Registry::get_instance().record_db_query(operation_, std::chrono::steady_clock::now() - start_,
+    std::uncaught_exceptions() > exceptions_);
+}
@@ -0,0 +1,124 @@
+#include "admission_controller.hpp"
+
+server::AdmissionPermit::AdmissionPermit(AdmissionController& controller, Kind kind):
+  controller_(&controller),
+  kind_(kind),
+  created_(std::chrono::steady_clock::now())
+{}
+
+server::AdmissionPermit::AdmissionPermit(AdmissionPermit&& other) noexcept:
+  controller_(other.controller_),
+  kind_(other.kind_),
+  created_(other.created_)
+{
+  other.controller_ = nullptr;
+}
+
+server::AdmissionPermit::~AdmissionPermit()
+{
+  if (controller_)
+  {
+    controller_->release(kind_);
+  }
+}
+
+bool server::AdmissionPermit::start()
+{
+  return !controller_ || controller_->check_queue_delay(created_);
+}
+
+server::AdmissionController::AdmissionController(const AdmissionConfig& config):
+  config_(config),
+  sessions_(0),
+  inflight_(0),
+  rejected_sessions_(0),
+  shed_inflight_(0),
+  shed_queue_delay_(0),
+  min_delay_(std::chrono::nanoseconds::max()),
+  interval_end_(std::chrono::steady_clock::now() + config.interval),
+  overloaded_(false)
+{}
+
+std::optional< server::AdmissionPermit > server::AdmissionController::try_open_session()
+{
+  size_t sessions = sessions_.fetch_add(1, std::memory_order_relaxed);
+  if (config_.max_sessions != 0 && sessions >= config_.max_sessions)
+  {
+    sessions_.fetch_sub(1, std::memory_order_relaxed);
+    rejected_sessions_.fetch_add(1, std::memory_order_relaxed);
+    return std::nullopt;
+  }
+
+  return std::optional< AdmissionPermit >(std::in_place, *this, AdmissionPermit::Kind::SESSION);
+}
+
+std::optional< server::AdmissionPermit > server::AdmissionController::try_admit_request()
+{
+  size_t inflight = inflight_.fetch_add(1, std::memory_order_relaxed);
+  if (config_.max_inflight != 0 && inflight >= config_.max_inflight)
+  {
+    inflight_.fetch_sub(1, std::memory_order_relaxed);
+    shed_inflight_.fetch_add(1, std::memory_order_relaxed);
+    return std::nullopt;
+  }
+
+  return std::optional< AdmissionPermit >(std::in_place, *this, AdmissionPermit::Kind::REQUEST);
+}
+
+server::AdmissionStats server::AdmissionController::get_stats() const
+{
+  AdmissionStats stats;
+  stats.sessions = sessions_.load(std::memory_order_relaxed);
+  stats.inflight = inflight_.load(std::memory_order_relaxed);
+  stats.rejected_sessions = rejected_sessions_.load(std::memory_order_relaxed);
+  stats.shed_inflight = shed_inflight_.load(std::memory_order_relaxed);
+  stats.shed_queue_delay = shed_queue_delay_.load(std::memory_order_relaxed);
+
+  std::lock_guard< std::mutex > lock(delay_mutex_);
+  stats.overloaded = overloaded_;
+  return stats;
+}
+
+std::chrono::seconds server::AdmissionController::get_retry_after() const
+{
+  return config_.retry_after;
+}
+
+bool server::AdmissionController::check_queue_delay(std::chrono::steady_clock::time_point enqueued)
+{
+  if (config_.target_delay.count() == 0)
+  {
+    return true;
+  }
+
+  auto now = std::chrono::steady_clock::now();
+  std::chrono::nanoseconds delay = now - enqueued;
+
+  std::lock_guard< std::mutex > lock(delay_mutex_);
+  min_delay_ = std::min(min_delay_, delay);
+  if (now >= interval_end_)
+  {
+    overloaded_ = min_delay_ > config_.target_delay;
+    min_delay_ = std::chrono::nanoseconds::max();
+    interval_end_ = now + config_.interval;
+  }
+
+  if (overloaded_ && delay > 2 * config_.target_delay)
+  {
+    shed_queue_delay_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  return true;
+}
+
+void server::AdmissionController::release(AdmissionPermit::Kind kind)
+{
+  if (kind == AdmissionPermit::Kind::SESSION)
+  {
+    sessions_.fetch_sub(1, std::memory_order_relaxed);
+  }
+  else
+  {
+    inflight_.fetch_sub(1, std::memory_order_relaxed);
+  }
+}
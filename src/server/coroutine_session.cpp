@@ -0,0 +1,352 @@
+#include "coroutine_session.hpp"
+
+namespace
+{
+  void log_coroutine_error(std::exception_ptr error)
+  {
+    if (!error)
+    {
+      return;
+    }
+
+    try
+    {
+      std::rethrow_exception(error);
+    }
+    catch (const std::exception& e)
+    {
+      LOG(logger::LogLevel::ERROR, "Error in session: {}", e.what());
+    }
+  }
+}
+
+server::CoroutineSession::CoroutineSession(tcp::socket&& socket, std::shared_ptr< const SessionContext > context,
+  AdmissionPermit permit):
+  stream_(std::move(socket)),
+  context_(context),
+  permit_(std::move(permit)),
+  read_signal_(stream_.get_executor()),
+  write_signal_(stream_.get_executor()),
+  read_stopped_(false),
+  closed_(false),
+  linger_(false)
+{
+  metrics::Registry::get_instance().session_opened();
+}
+
+server::CoroutineSession::~CoroutineSession()
+{
+  metrics::Registry::get_instance().session_closed();
+}
+
+void server::CoroutineSession::run()
+{
+  net::co_spawn(stream_.get_executor(), read_loop(shared_from_this()), log_coroutine_error);
+  net::co_spawn(stream_.get_executor(), write_loop(shared_from_this()), log_coroutine_error);
+}
+
+void server::CoroutineSession::do_close()
+{
+  closed_ = true;
+  if (linger_)
+  {
+    std::make_shared< LingeringClose >(stream_.release_socket())->run();
+    return;
+  }
+
+  beast::error_code ec;
+  stream_.socket().shutdown(tcp::socket::shutdown_send, ec);
+}
+
+net::awaitable< void > server::CoroutineSession::read_loop(std::shared_ptr< CoroutineSession > self)
+{
+  boost::ignore_unused(self);
+
+  while (!read_stopped_ && !closed_)
+  {
+    if (exchanges_.size() >= context_->pipeline_limit)
+    {
+      co_await wait(read_signal_);
+      continue;
+    }
+
+    spare_body_.clear();
+    http::request< http::string_body > req;
+    req.body() = std::move(spare_body_);
+
+    http::request_parser< http::string_body > parser(std::move(req));
+    parser.header_limit(context_->header_limit);
+    parser.body_limit(context_->body_limit);
+
+    beast::error_code ec;
+    stream_.expires_after(std::chrono::seconds(30));
+    size_t bytes = co_await http::async_read_header(stream_, buffer_, parser, net::redirect_error(net::use_awaitable, ec));
+    metrics::Registry::get_instance().record_bytes_received(bytes);
+    std::chrono::steady_clock::time_point read_started;
+    if (context_->tracer->is_enabled())
+    {
+      read_started = std::chrono::steady_clock::now();
+    }
+
+    if (ec == http::error::end_of_stream)
+    {
+      LOG(logger::LogLevel::INFO, "Connection closed by client");
+      read_stopped_ = true;
+      break;
+    }
+    if (ec == http::error::header_limit)
+    {
+      reject_request(parser.release(), http::status::request_header_fields_too_large, "Request header too large");
+      break;
+    }
+    if (!ec && beast::iequals(parser.get()[http::field::expect], "100-continue"))
+    {
+      // write_loop is idle only once every earlier response is written, and nothing new is queued until this body is read
+      while (!exchanges_.empty() && !closed_)
+      {
+        co_await wait(read_signal_);
+      }
+      if (closed_)
+      {
+        break;
+      }
+
+      bytes = co_await net::async_write(stream_, net::buffer(Session::continue_response.data(),
+        Session::continue_response.size()), net::redirect_error(net::use_awaitable, ec));
+      metrics::Registry::get_instance().record_bytes_sent(bytes);
+      if (ec)
+      {
+        read_stopped_ = true;
+        log_connection_error("writing", ec, parser.get());
+        break;
+      }
+    }
+    if (!ec)
+    {
+      bytes = co_await http::async_read(stream_, buffer_, parser, net::redirect_error(net::use_awaitable, ec));
+      metrics::Registry::get_instance().record_bytes_received(bytes);
+    }
+
+    if (ec == http::error::body_limit)
+    {
+      reject_request(parser.release(), http::status::payload_too_large, "Request body too large");
+      break;
+    }
+    if (ec)
+    {
+      read_stopped_ = true;
+      log_connection_error("reading", ec, parser.get());
+      break;
+    }
+
+    Exchange& exchange = exchanges_.emplace_back();
+    exchange.req = parser.release();
+
+    log_connection("Request", exchange.req);
+
+    begin_exchange(exchange, *context_, read_started);
+    read_stopped_ = !exchange.req.keep_alive();
+
+    if (!exchange.route)
+    {
+      log_connection_error("reading", "Method not found", exchange.req);
+
+      exchange.res = utils::create_response(http::status::not_found, true, "Not found");
+      exchange.ready = true;
+      write_signal_.cancel();
+    }
+    else if (!admit_exchange(exchange, *context_))
+    {
+      write_signal_.cancel();
+    }
+    else
+    {
+      dispatch_requests();
+    }
+  }
+
+  write_signal_.cancel();
+}
+
+net::awaitable< void > server::CoroutineSession::write_loop(std::shared_ptr< CoroutineSession > self)
+{
+  boost::ignore_unused(self);
+
+  while (!closed_)
+  {
+    if (exchanges_.empty())
+    {
+      if (read_stopped_)
+      {
+        do_close();
+        break;
+      }
+      co_await wait(write_signal_);
+      continue;
+    }
+
+    Exchange& exchange = exchanges_.front();
+    if (!exchange.ready)
+    {
+      co_await wait(write_signal_);
+      continue;
+    }
+
+    begin_write(exchange);
+
+    bool keep_alive = false;
+    if (exchange.response_stream)
+    {
+      keep_alive = co_await write_stream(exchange);
+    }
+    else
+    {
+      keep_alive = co_await write_response(exchange);
+    }
+
+    if (closed_)
+    {
+      break;
+    }
+
+    log_connection("Response", exchange.req);
+    record_exchange(exchange, *context_);
+
+    spare_body_ = std::move(exchange.req.body());
+    exchanges_.pop_front();
+    read_signal_.cancel();
+
+    if (!keep_alive)
+    {
+      do_close();
+      break;
+    }
+  }
+
+  read_signal_.cancel();
+}
+
+void server::CoroutineSession::dispatch_requests()
+{
+  dispatch_exchanges(exchanges_, [this](Exchange& exchange)
+  {
+    net::co_spawn(stream_.get_executor(), handle_request(shared_from_this(), &exchange), log_coroutine_error);
+  });
+}
+
+net::awaitable< void > server::CoroutineSession::handle_request(std::shared_ptr< CoroutineSession > self, Exchange* exchange)
+{
+  boost::ignore_unused(self);
+
+  co_await net::co_spawn(context_->db_executor, process(exchange), net::use_awaitable);
+
+  exchange->ready = true;
+  dispatch_requests();
+  write_signal_.cancel();
+}
+
+net::awaitable< void > server::CoroutineSession::process(Exchange* exchange)
+{
+  process_exchange(*exchange, *context_);
+  co_return;
+}
+
+net::awaitable< bool > server::CoroutineSession::write_response(Exchange& exchange)
+{
+  bool keep_alive = exchange.res.keep_alive() && exchange.req.keep_alive();
+
+  beast::error_code ec;
+  stream_.expires_after(std::chrono::seconds(30));
+  size_t bytes = co_await http::async_write(stream_, exchange.res, net::redirect_error(net::use_awaitable, ec));
+  metrics::Registry::get_instance().record_bytes_sent(bytes);
+
+  if (ec)
+  {
+    log_connection_error("writing", ec, exchange.req);
+    closed_ = true;
+    stream_.socket().close(ec);
+    co_return false;
+  }
+
+  co_return keep_alive;
+}
+
+net::awaitable< bool > server::CoroutineSession::write_stream(Exchange& exchange)
+{
+  http::response_serializer< http::empty_body > serializer(exchange.response_stream->get_header());
+  std::string chunk;
+
+  beast::error_code ec;
+  stream_.expires_after(std::chrono::seconds(30));
+  size_t bytes = co_await http::async_write_header(stream_, serializer, net::redirect_error(net::use_awaitable, ec));
+  metrics::Registry::get_instance().record_bytes_sent(bytes);
+
+  bool has_more = true;
+  while (!ec && has_more)
+  {
+    chunk.clear();
+    try
+    {
+      has_more = co_await net::co_spawn(context_->db_executor, fetch_next_chunk(&exchange, &chunk), net::use_awaitable);
+    }
+    catch (const std::exception& e)
+    {
+      log_connection_error("streaming", e.what(), exchange.req);
+      do_close();
+      co_return false;
+    }
+
+    stream_.expires_after(std::chrono::seconds(30));
+    if (has_more)
+    {
+      bytes = co_await net::async_write(stream_, http::make_chunk(net::buffer(chunk)), net::redirect_error(net::use_awaitable, ec));
+    }
+    else
+    {
+      bytes = co_await net::async_write(stream_, beast::buffers_cat(http::make_chunk(net::buffer(chunk)),
+        http::make_chunk_last()), net::redirect_error(net::use_awaitable, ec));
+    }
+    metrics::Registry::get_instance().record_bytes_sent(bytes);
+  }
+
+  if (ec)
+  {
+    log_connection_error(has_more ? "streaming" : "writing", ec, exchange.req);
+    closed_ = true;
+    stream_.socket().close(ec);
+    co_return false;
+  }
+
+  co_return exchange.response_stream->get_header().keep_alive();
+}
+
+net::awaitable< bool > server::CoroutineSession::fetch_next_chunk(Exchange* exchange, std::string* chunk)
+{
+  co_return exchange->response_stream->next_chunk(*chunk);
+}
+
+net::awaitable< void > server::CoroutineSession::wait(net::steady_timer& signal)
+{
+  signal.expires_at(net::steady_timer::time_point::max());
+
+  beast::error_code ec;
+  co_await signal.async_wait(net::redirect_error(net::use_awaitable, ec));
+}
+
+void server::CoroutineSession::reject_request(http::request< http::string_body > req, http::status status,
+  const std::string& message)
+{
+  read_stopped_ = true;
+  linger_ = true;
+
+  Exchange& exchange = exchanges_.emplace_back();
+  exchange.req = std::move(req);
+  exchange.started = std::chrono::steady_clock::now();
+
+  log_connection_error("reading", message, exchange.req);
+
+  exchange.res = utils::create_response(status, true, message);
+  exchange.res.keep_alive(false);
+  exchange.ready = true;
+  write_signal_.cancel();
+}
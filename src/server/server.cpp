@@ -1,10 +1,158 @@
 #include "server.hpp"
+#include "coroutine_session.hpp"
+#include "get_metrics_handler.hpp"
+#include <sstream>
 
-server::Session::Session(tcp::socket&& socket, std::shared_ptr< database::Database > db):
-  stream_(std::move(socket)),
-  db_(db)
+bool server::is_safe_method(http::verb method)
+{
+  return method == http::verb::get || method == http::verb::head;
+}
+
+bool server::admit_exchange(Exchange& exchange, const SessionContext& context)
+{
+  auto permit = context.admission->try_admit_request();
+  if (permit)
+  {
+    exchange.permit.emplace(std::move(*permit));
+    if (exchange.trace)
+    {
+      exchange.trace->begin(tracing::Phase::QUEUE);
+    }
+    return true;
+  }
+
+  exchange.res = utils::create_unavailable_response(context.admission->get_retry_after());
+  exchange.ready = true;
+  return false;
+}
+
+void server::process_exchange(Exchange& exchange, const SessionContext& context)
+{
+  if (exchange.trace)
+  {
+    exchange.trace->end(tracing::Phase::QUEUE);
+  }
+  tracing::ActiveTrace active_trace(exchange.trace.get());
+
+  if (exchange.permit && !exchange.permit->start())
+  {
+    exchange.permit.reset();
+    exchange.res = utils::create_unavailable_response(context.admission->get_retry_after());
+    return;
+  }
+
+  try
+  {
+    tracing::PhaseTimer timer(exchange.trace.get(), tracing::Phase::HANDLER);
+    exchange.response_stream = exchange.route->handler->open_stream(exchange.req, exchange.route->params, context.db);
+    if (!exchange.response_stream)
+    {
+      exchange.res = exchange.route->handler->handle_request(exchange.req, exchange.route->params, context.db);
+    }
+  }
+  catch (const std::exception& e)
+  {
+    log_connection_error("handling", e.what(), exchange.req);
+
+    exchange.res = utils::create_response(http::status::internal_server_error, true, e.what());
+  }
+  // A stream keeps querying the database while it is written, so its permit lives until the exchange is done
+  if (!exchange.response_stream)
+  {
+    exchange.permit.reset();
+  }
+
+  try
+  {
+    tracing::PhaseTimer timer(exchange.trace.get(), tracing::Phase::COMPRESS);
+    const utils::CompressionConfig& config = context.compression;
+    auto accept_encoding = exchange.req[http::field::accept_encoding];
+
+    if (!exchange.response_stream)
+    {
+      utils::compress_response(exchange.res, accept_encoding, config);
+    }
+    else if (config.enabled)
+    {
+      exchange.response_stream->get_header().set(http::field::vary, "Accept-Encoding");
+
+      auto encoding = utils::negotiate_encoding(accept_encoding);
+      if (encoding != utils::ContentEncoding::IDENTITY)
+      {
+        exchange.response_stream = std::make_unique< handlers::CompressedResponseStream >(std::move(exchange.response_stream),
+          encoding, config.level);
+      }
+    }
+  }
+  catch (const std::exception& e)
+  {
+    log_connection_error("compressing", e.what(), exchange.req);
+  }
+}
+
+
+server::LingeringClose::LingeringClose(tcp::socket&& socket):
+  socket_(std::move(socket)),
+  timer_(socket_.get_executor()),
+  buffer_()
 {}
 
+void server::LingeringClose::run()
+{
+  beast::error_code ec;
+  socket_.shutdown(tcp::socket::shutdown_send, ec);
+
+  timer_.expires_after(timeout);
+  timer_.async_wait(beast::bind_front_handler(&LingeringClose::on_timeout, shared_from_this()));
+  do_read();
+}
+
+void server::LingeringClose::do_read()
+{
+  socket_.async_read_some(net::buffer(buffer_), beast::bind_front_handler(&LingeringClose::on_read, shared_from_this()));
+}
+
+void server::LingeringClose::on_read(beast::error_code ec, std::size_t bytes_transferred)
+{
+  metrics::Registry::get_instance().record_bytes_received(bytes_transferred);
+
+  if (ec)
+  {
+    timer_.cancel();
+    socket_.close(ec);
+    return;
+  }
+  do_read();
+}
+
+void server::LingeringClose::on_timeout(beast::error_code ec)
+{
+  if (ec != net::error::operation_aborted)
+  {
+    socket_.close(ec);
+  }
+}
+
+
+server::Session::Session(tcp::socket&& socket, std::shared_ptr< const SessionContext > context, AdmissionPermit permit):
+  stream_(std::move(socket)),
+  context_(context),
+  permit_(std::move(permit)),
+  reading_(false),
+  writing_(false),
+  read_stopped_(false),
+  closed_(false),
+  linger_(false),
+  continue_pending_(false)
+{
+  metrics::Registry::get_instance().session_opened();
+}
+
+server::Session::~Session()
+{
+  metrics::Registry::get_instance().session_closed();
+}
+
 void server::Session::run()
 {
   net::dispatch(stream_.get_executor(), beast::bind_front_handler(&Session::do_read, shared_from_this()));
@@ -12,141 +160,437 @@ void server::Session::run()
 
 void server::Session::do_read()
 {
+  spare_body_.clear();
   req_ = {};
-  buffer_.consume(buffer_.size());
+  req_.body() = std::move(spare_body_);
+
+  parser_.emplace(std::move(req_));
+  parser_->header_limit(context_->header_limit);
+  parser_->body_limit(context_->body_limit);
+
+  reading_ = true;
   stream_.expires_after(std::chrono::seconds(30));
 
-  http::async_read(stream_, buffer_, req_, beast::bind_front_handler(&Session::on_read, shared_from_this()));
+  http::async_read_header(stream_, buffer_, *parser_, beast::bind_front_handler(&Session::on_read_header, shared_from_this()));
 }
 
-void server::Session::on_read(beast::error_code ec, std::size_t bytes_transferred)
+void server::Session::on_read_header(beast::error_code ec, std::size_t bytes_transferred)
 {
-  boost::ignore_unused(bytes_transferred);
+  metrics::Registry::get_instance().record_bytes_received(bytes_transferred);
+  if (context_->tracer->is_enabled())
+  {
+    read_started_ = std::chrono::steady_clock::now();
+  }
 
-  if (ec)
+  if (ec == http::error::end_of_stream)
   {
-    if (ec == http::error::end_of_stream)
+    reading_ = false;
+    LOG(logger::LogLevel::INFO, "Connection closed by client");
+    if (exchanges_.empty())
     {
-      LOG(logger::LogLevel::INFO, "Connection closed by client");
       return do_close();
     }
-    log_connection_error("reading", ec);
+    read_stopped_ = true;
+    return;
+  }
+  if (ec == http::error::header_limit)
+  {
+    return reject_request(http::status::request_header_fields_too_large, "Request header too large");
+  }
+  if (ec == http::error::body_limit)
+  {
+    return reject_request(http::status::payload_too_large, "Request body too large");
+  }
+  if (ec)
+  {
+    reading_ = false;
+    read_stopped_ = true;
+    log_connection_error("reading", ec, parser_->get());
     return;
   }
 
-  log_connection("Request");
+  if (beast::iequals(parser_->get()[http::field::expect], "100-continue"))
+  {
+    // The interim response must not interleave with or overtake responses to earlier pipelined requests
+    if (!exchanges_.empty() || writing_)
+    {
+      continue_pending_ = true;
+      return;
+    }
+    return write_continue();
+  }
 
-  std::unique_ptr< handlers::RequestHandler > handler = handlers::HandlerFactory().create_handler(req_);
-  if (!handler)
+  do_read_body();
+}
+
+void server::Session::write_continue()
+{
+  writing_ = true;
+  net::async_write(stream_, net::buffer(continue_response.data(), continue_response.size()),
+    beast::bind_front_handler(&Session::on_write_continue, shared_from_this()));
+}
+
+void server::Session::on_write_continue(beast::error_code ec, std::size_t bytes_transferred)
+{
+  metrics::Registry::get_instance().record_bytes_sent(bytes_transferred);
+  writing_ = false;
+
+  if (ec)
   {
-    log_connection_error("reading", "Method not found");
+    reading_ = false;
+    read_stopped_ = true;
+    log_connection_error("writing", ec, parser_->get());
+    return;
+  }
+
+  do_read_body();
+}
+
+void server::Session::do_read_body()
+{
+  http::async_read(stream_, buffer_, *parser_, beast::bind_front_handler(&Session::on_read, shared_from_this()));
+}
+
+void server::Session::on_read(beast::error_code ec, std::size_t bytes_transferred)
+{
+  metrics::Registry::get_instance().record_bytes_received(bytes_transferred);
+
+  if (ec == http::error::body_limit)
+  {
+    return reject_request(http::status::payload_too_large, "Request body too large");
+  }
+  if (ec)
+  {
+    reading_ = false;
+    read_stopped_ = true;
+    log_connection_error("reading", ec, parser_->get());
+    return;
+  }
+
+  reading_ = false;
+  req_ = parser_->release();
+  parser_.reset();
+
+  log_connection("Request", req_);
+
+  Exchange& exchange = exchanges_.emplace_back();
+  exchange.req = std::move(req_);
+  begin_exchange(exchange, *context_, read_started_);
+  read_stopped_ = !exchange.req.keep_alive();
+
+  if (!exchange.route)
+  {
+    log_connection_error("reading", "Method not found", exchange.req);
+
+    exchange.res = utils::create_response(http::status::not_found, true, "Not found");
+    exchange.ready = true;
+    do_write();
+  }
+  else if (!admit_exchange(exchange, *context_))
+  {
+    do_write();
+  }
+  else
+  {
+    dispatch_requests();
+  }
+
+  maybe_read();
+}
+
+void server::Session::dispatch_requests()
+{
+  dispatch_exchanges(exchanges_, [this](Exchange& exchange)
+  {
+    net::post(context_->db_executor, beast::bind_front_handler(&Session::handle_request, shared_from_this(), &exchange));
+  });
+}
 
-    send_response(std::move(utils::create_response(http::status::not_found, true, "Not found")));
+void server::Session::handle_request(Exchange* exchange)
+{
+  process_exchange(*exchange, *context_);
+
+  net::post(stream_.get_executor(), beast::bind_front_handler(&Session::on_handled, shared_from_this(), exchange));
+}
+
+void server::Session::on_handled(Exchange* exchange)
+{
+  exchange->ready = true;
+  dispatch_requests();
+  do_write();
+}
+
+void server::Session::do_write()
+{
+  if (writing_ || closed_ || exchanges_.empty() || !exchanges_.front().ready)
+  {
     return;
   }
+  writing_ = true;
 
-  http::response< http::string_body > res;
+  Exchange& exchange = exchanges_.front();
+  begin_write(exchange);
+  if (exchange.response_stream)
+  {
+    return send_stream(exchange);
+  }
+
+  bool keep_alive = exchange.res.keep_alive() && exchange.req.keep_alive();
+  stream_.expires_after(std::chrono::seconds(30));
+  http::async_write(stream_, exchange.res, beast::bind_front_handler(&Session::on_write, shared_from_this(), keep_alive));
+}
+
+void server::Session::send_stream(Exchange& exchange)
+{
+  stream_serializer_.emplace(exchange.response_stream->get_header());
+
+  stream_.expires_after(std::chrono::seconds(30));
+  http::async_write_header(stream_, *stream_serializer_,
+    beast::bind_front_handler(&Session::on_write_stream, shared_from_this(), &exchange));
+}
+
+void server::Session::fetch_next_chunk(Exchange* exchange)
+{
+  chunk_buffer_.clear();
+
+  bool has_more = false;
+  bool failed = false;
   try
   {
-    res = handler->handle_request(req_, db_);
+    has_more = exchange->response_stream->next_chunk(chunk_buffer_);
   }
   catch (const std::exception& e)
   {
-    log_connection_error("handling", e.what());
+    log_connection_error("streaming", e.what(), exchange->req);
+    failed = true;
+  }
 
-    send_response(std::move(utils::create_response(http::status::internal_server_error, true, e.what())));
+  net::post(stream_.get_executor(), beast::bind_front_handler(&Session::write_chunk, shared_from_this(), exchange, has_more, failed));
+}
+
+void server::Session::write_chunk(Exchange* exchange, bool has_more, bool failed)
+{
+  if (failed)
+  {
+    stream_serializer_.reset();
+    writing_ = false;
+    return do_close();
+  }
+
+  stream_.expires_after(std::chrono::seconds(30));
+
+  if (has_more)
+  {
+    net::async_write(stream_, http::make_chunk(net::buffer(chunk_buffer_)),
+      beast::bind_front_handler(&Session::on_write_stream, shared_from_this(), exchange));
     return;
   }
 
-  send_response(std::move(res));
+  bool keep_alive = exchange->response_stream->get_header().keep_alive();
+  stream_serializer_.reset();
+
+  net::async_write(stream_, beast::buffers_cat(http::make_chunk(net::buffer(chunk_buffer_)), http::make_chunk_last()),
+    beast::bind_front_handler(&Session::on_write, shared_from_this(), keep_alive));
 }
 
-void server::Session::send_response(http::message_generator&& msg)
+void server::Session::on_write_stream(Exchange* exchange, beast::error_code ec, std::size_t bytes_transferred)
 {
-  bool keep_alive = msg.keep_alive();
-  beast::async_write(stream_, std::move(msg), beast::bind_front_handler(&Session::on_write, shared_from_this(), keep_alive));
+  metrics::Registry::get_instance().record_bytes_sent(bytes_transferred);
+
+  if (ec)
+  {
+    log_connection_error("streaming", ec, exchange->req);
+
+    stream_serializer_.reset();
+    writing_ = false;
+    closed_ = true;
+    stream_.socket().close(ec);
+    return;
+  }
+
+  net::post(context_->db_executor, beast::bind_front_handler(&Session::fetch_next_chunk, shared_from_this(), exchange));
 }
 
 void server::Session::on_write(bool keep_alive, beast::error_code ec, std::size_t bytes_transferred)
 {
-  boost::ignore_unused(bytes_transferred);
+  metrics::Registry::get_instance().record_bytes_sent(bytes_transferred);
+
+  writing_ = false;
+  Exchange& exchange = exchanges_.front();
 
   if (ec)
   {
-    log_connection_error("writing", ec);
-
+    log_connection_error("writing", ec, exchange.req);
+    closed_ = true;
+    stream_.socket().close(ec);
     return;
   }
 
-  log_connection("Response");
+  log_connection("Response", exchange.req);
+  record_exchange(exchange, *context_);
 
-  buffer_.consume(buffer_.size());
+  spare_body_ = std::move(exchange.req.body());
+  exchanges_.pop_front();
 
   if (!keep_alive)
   {
     return do_close();
   }
 
-  do_read();
+  if (continue_pending_ && exchanges_.empty())
+  {
+    continue_pending_ = false;
+    return write_continue();
+  }
+
+  maybe_read();
+  do_write();
+
+  if (read_stopped_ && !reading_ && exchanges_.empty())
+  {
+    do_close();
+  }
+}
+
+void server::Session::maybe_read()
+{
+  if (!reading_ && !read_stopped_ && !closed_ && exchanges_.size() < context_->pipeline_limit)
+  {
+    do_read();
+  }
 }
 
 void server::Session::do_close()
 {
+  closed_ = true;
+  if (linger_)
+  {
+    std::make_shared< LingeringClose >(stream_.release_socket())->run();
+    return;
+  }
+
   beast::error_code ec;
   stream_.socket().shutdown(tcp::socket::shutdown_send, ec);
 }
 
-void server::Session::log_connection(const std::string& context)
+void server::Session::reject_request(http::status status, const std::string& message)
+{
+  reading_ = false;
+  read_stopped_ = true;
+  linger_ = true;
+
+  Exchange& exchange = exchanges_.emplace_back();
+  exchange.req = parser_->release();
+  exchange.started = std::chrono::steady_clock::now();
+  parser_.reset();
+
+  log_connection_error("reading", message, exchange.req);
+
+  exchange.res = utils::create_response(status, true, message);
+  exchange.res.keep_alive(false);
+  exchange.ready = true;
+  do_write();
+}
+
+void server::begin_exchange(Exchange& exchange, const SessionContext& context,
+  std::chrono::steady_clock::time_point read_started)
+{
+  exchange.started = std::chrono::steady_clock::now();
+  if (context.tracer->is_enabled())
+  {
+    exchange.trace = context.tracer->start(std::string_view(exchange.req["traceparent"]));
+    if (exchange.trace)
+    {
+      exchange.trace->add(tracing::Phase::READ, read_started, exchange.started);
+    }
+  }
+
+  tracing::PhaseTimer timer(exchange.trace.get(), tracing::Phase::ROUTE);
+  exchange.route = context.router->match(exchange.req.method(), exchange.req.target());
+}
+
+void server::begin_write(Exchange& exchange)
+{
+  if (!exchange.trace)
+  {
+    return;
+  }
+
+  if (exchange.trace->has_server_timing())
+  {
+    http::fields& fields = exchange.response_stream ? static_cast< http::fields& >(exchange.response_stream->get_header()) :
+      static_cast< http::fields& >(exchange.res);
+    fields.set("Server-Timing", exchange.trace->get_server_timing());
+  }
+  exchange.trace->begin(tracing::Phase::WRITE);
+}
+
+void server::record_exchange(Exchange& exchange, const SessionContext& context)
 {
-  std::string log_message = std::format("{} - Method: {}; Target: {}",
+  unsigned status = exchange.response_stream ? exchange.response_stream->get_header().result_int() : exchange.res.result_int();
+  metrics::Registry::get_instance().record_request(exchange.route ? exchange.route->route : metrics::unmatched_route, status,
+    std::chrono::steady_clock::now() - exchange.started);
+
+  if (exchange.trace)
+  {
+    exchange.trace->end(tracing::Phase::WRITE);
+    context.tracer->finish(*exchange.trace, std::string_view(exchange.req.method_string()),
+      exchange.route ? context.router->get_pattern(exchange.route->route) : std::string_view(), status);
+  }
+}
+
+void server::log_connection(std::string_view context, const http::request< http::string_body >& req)
+{
+  LOG(logger::LogLevel::INFO, "{} - Method: {}; Target: {}",
     context,
-    std::string(req_.method_string()),
-    std::string(req_.target())
+    std::string_view(req.method_string()),
+    std::string_view(req.target())
   );
-
-  LOG(logger::LogLevel::INFO, log_message);
 }
 
-void server::Session::log_connection_error(const std::string& context, const std::string& error)
+void server::log_connection_error(std::string_view context, std::string_view error,
+  const http::request< http::string_body >& req)
 {
-  std::string log_message = std::format("Error in {}: {} - Method: {}; Target: {}",
+  LOG(logger::LogLevel::ERROR, "Error in {}: {} - Method: {}; Target: {}",
     context,
     error,
-    std::string(req_.method_string()),
-    std::string(req_.target())
+    std::string_view(req.method_string()),
+    std::string_view(req.target())
   );
-
-  LOG(logger::LogLevel::ERROR, log_message);
 }
 
-void server::Session::log_connection_error(const std::string& context, boost::beast::error_code ec)
+void server::log_connection_error(std::string_view context, boost::beast::error_code ec,
+  const http::request< http::string_body >& req)
 {
-  std::string log_message;
   if (ec == beast::error::timeout)
   {
-    log_message = std::format("Timeout in {}",
+    LOG(logger::LogLevel::WARNING, "Timeout in {}",
       context
     );
-
-    LOG(logger::LogLevel::WARNING, log_message);
   }
   else
   {
-    log_message = std::format("Error in {}: {} - Method: {}; Target: {}",
+    LOG(logger::LogLevel::ERROR, "Error in {}: {} - Method: {}; Target: {}",
       context,
       ec.what(),
-      std::string(req_.method_string()),
-      std::string(req_.target())
+      std::string_view(req.method_string()),
+      std::string_view(req.target())
     );
-    LOG(logger::LogLevel::ERROR, log_message);
   }
 }
 
-server::Listener::Listener(net::io_context& ioc, std::shared_ptr< database::Database > db):
+server::Listener::Listener(net::io_context& ioc, std::shared_ptr< const SessionContext > context):
   ioc_(ioc),
   acceptor_(net::make_strand(ioc)),
-  db_(db)
-{}
+  context_(context)
+{
+  auto res = utils::create_unavailable_response(context_->admission->get_retry_after());
+  res.keep_alive(false);
+
+  std::ostringstream response;
+  response << res;
+  overloaded_response_ = response.str();
+}
 
 void server::Listener::run()
 {
@@ -162,23 +606,47 @@ void server::Listener::on_accept(beast::error_code ec, tcp::socket socket)
 {
   if (ec)
   {
-    std::string error = "Error in accepting: " + ec.what();
-    LOG(logger::LogLevel::ERROR, error);
+    LOG(logger::LogLevel::ERROR, "Error in accepting: {}", ec.what());
     return;
   }
+  else if (auto permit = context_->admission->try_open_session())
+  {
+    if (context_->session_mode == SessionMode::COROUTINE)
+    {
+      std::make_shared< CoroutineSession >(std::move(socket), context_, std::move(*permit))->run();
+    }
+    else
+    {
+      std::make_shared< Session >(std::move(socket), context_, std::move(*permit))->run();
+    }
+  }
   else
   {
-    std::make_shared< Session >(std::move(socket), db_)->run();
+    auto rejected = std::make_shared< tcp::socket >(std::move(socket));
+    net::async_write(*rejected, net::buffer(overloaded_response_),
+      beast::bind_front_handler(&Listener::on_reject, shared_from_this(), rejected));
   }
 
   do_accept();
 }
 
+void server::Listener::on_reject(std::shared_ptr< tcp::socket > socket, beast::error_code ec, std::size_t bytes_transferred)
+{
+  metrics::Registry::get_instance().record_bytes_sent(bytes_transferred);
+
+  if (ec)
+  {
+    socket->close(ec);
+    return;
+  }
+  std::make_shared< LingeringClose >(std::move(*socket))->run();
+}
+
 std::expected< std::shared_ptr< server::Listener >, std::string > server::Listener::create(net::io_context& ioc,
-  tcp::endpoint endpoint, std::shared_ptr< database::Database > db)
+  tcp::endpoint endpoint, std::shared_ptr< const SessionContext > context, bool reuse_port)
 {
   beast::error_code ec;
-  auto listener = std::make_shared< Listener >(ioc, db);
+  auto listener = std::make_shared< Listener >(ioc, context);
 
   listener->acceptor_.open(endpoint.protocol(), ec);
   if (ec)
@@ -192,6 +660,19 @@ std::expected< std::shared_ptr< server::Listener >, std::string > server::Listen
     return std::unexpected(ec.message());
   }
 
+  if (reuse_port)
+  {
+#ifdef SO_REUSEPORT
+    listener->acceptor_.set_option(net::detail::socket_option::boolean< SOL_SOCKET, SO_REUSEPORT >(true), ec);
+    if (ec)
+    {
+      return std::unexpected(ec.message());
+    }
+#else
+    return std::unexpected("SO_REUSEPORT is not supported on this platform");
+#endif
+  }
+
   listener->acceptor_.bind(endpoint, ec);
   if (ec)
   {
@@ -207,26 +688,70 @@ std::expected< std::shared_ptr< server::Listener >, std::string > server::Listen
   return listener;
 }
 
-server::Server::Server(const std::string& host, unsigned short port, size_t threads_num, std::shared_ptr< database::Database > db):
+server::Server::Server(const std::string& host, unsigned short port, size_t threads_num, std::shared_ptr< database::Database > db,
+  const ServerConfig& config):
   host_(host),
   port_(port),
   threads_num_(std::max(static_cast< size_t >(1), threads_num)),
   running_(false),
-  ioc_(threads_num_),
-  listener_(),
+  stopped_(false),
+  io_contexts_(),
+  db_pool_(std::max(static_cast< size_t >(1), config.db_threads_num)),
+  listeners_(),
   thread_pool_(),
-  db_(db)
+  db_(db),
+  admission_(std::make_shared< AdmissionController >(config.admission))
 {
   auto const address = net::ip::make_address(host);
   auto const endpoint = tcp::endpoint(address, port);
 
-  auto listener = Listener::create(ioc_, endpoint, db);
-  if (!listener.has_value())
+  auto context = std::make_shared< SessionContext >();
+  context->db = db;
+  context->db_executor = db_pool_.get_executor();
+  auto router = handlers::Router::create_default();
+  if (config.metrics)
+  {
+    router.add(http::verb::get, "/metrics", std::make_unique< handlers::GetMetricsHandler >(admission_));
+  }
+
+  std::vector< metrics::RouteLabel > route_labels;
+  for (const auto& [method, pattern]: router.get_routes())
+  {
+    route_labels.push_back({ std::string(http::to_string(method)), pattern });
+  }
+  metrics::Registry::get_instance().set_routes(std::move(route_labels));
+
+  context->router = std::make_shared< const handlers::Router >(std::move(router));
+  context->header_limit = config.header_limit;
+  context->body_limit = config.body_limit;
+  context->pipeline_limit = std::max(static_cast< size_t >(1), config.pipeline_limit);
+  context->compression = config.compression;
+  context->session_mode = config.session_mode;
+  context->admission = admission_;
+  context->tracer = std::make_shared< tracing::Tracer >(config.tracing);
+
+  if (config.reuse_port)
+  {
+    for (size_t i = 0; i != threads_num_; ++i)
+    {
+      io_contexts_.push_back(std::make_unique< net::io_context >(1));
+    }
+  }
+  else
   {
-    throw std::runtime_error(listener.error());
+    io_contexts_.push_back(std::make_unique< net::io_context >(static_cast< int >(threads_num_)));
   }
 
-  listener_ = std::move(listener.value());
+  for (size_t i = 0; i != io_contexts_.size(); ++i)
+  {
+    auto listener = Listener::create(*io_contexts_[i], endpoint, context, config.reuse_port);
+    if (!listener.has_value())
+    {
+      throw std::runtime_error(listener.error());
+    }
+
+    listeners_.push_back(std::move(listener.value()));
+  }
 }
 
 server::Server::~Server()
@@ -241,16 +766,24 @@ void server::Server::start()
     LOG(logger::LogLevel::INFO, "Server already running");
     return;
   }
+  if (stopped_)
+  {
+    throw std::logic_error("Server can't be restarted after stop");
+  }
   running_ = true;
 
-  listener_->run();
+  for (size_t i = 0; i != listeners_.size(); ++i)
+  {
+    listeners_[i]->run();
+  }
 
   thread_pool_.reserve(threads_num_);
   for (size_t i = 0; i != threads_num_; ++i)
   {
-    thread_pool_.emplace_back([this]()
+    net::io_context& ioc = *io_contexts_[i % io_contexts_.size()];
+    thread_pool_.emplace_back([&ioc]()
     {
-      ioc_.run();
+      ioc.run();
     });
   }
 
@@ -265,12 +798,22 @@ void server::Server::stop()
     return;
   }
   running_ = false;
+  stopped_ = true;
 
-  ioc_.stop();
+  for (size_t i = 0; i != io_contexts_.size(); ++i)
+  {
+    io_contexts_[i]->stop();
+  }
 
   std::this_thread::sleep_for(std::chrono::milliseconds(100));
 
   thread_pool_.clear();
+  db_pool_.join();
 
   LOG(logger::LogLevel::INFO, "Server stopped");
 }
+
+server::AdmissionStats server::Server::get_admission_stats() const
+{
+  return admission_->get_stats();
+}
@@ -0,0 +1,272 @@
+#include "tracing.hpp"
+#include <algorithm>
+#include <charconv>
+#include <format>
+#include <iterator>
+#include <random>
+#include <stdexcept>
+
+namespace
+{
+  std::mt19937_64& get_random()
+  {
+    thread_local std::mt19937_64 random(std::random_device{}());
+    return random;
+  }
+
+  uint64_t make_id()
+  {
+    uint64_t id = 0;
+    while (id == 0)
+    {
+      id = get_random()();
+    }
+    return id;
+  }
+
+  bool parse_hex(std::string_view value, uint64_t& result)
+  {
+    auto [ptr, ec] = std::from_chars(value.data(), value.data() + value.size(), result, 16);
+    return ec == std::errc() && ptr == value.data() + value.size();
+  }
+
+  bool parse_traceparent(std::string_view value, uint64_t& trace_high, uint64_t& trace_low, uint64_t& parent, bool& sampled)
+  {
+    if (value.size() < 55 || value[2] != '-' || value[35] != '-' || value[52] != '-' || value.substr(0, 2) == "ff")
+    {
+      return false;
+    }
+    if (value.size() > 55 && (value.substr(0, 2) == "00" || value[55] != '-'))
+    {
+      return false;
+    }
+
+    uint64_t flags = 0;
+    if (!parse_hex(value.substr(3, 16), trace_high) || !parse_hex(value.substr(19, 16), trace_low) ||
+      !parse_hex(value.substr(36, 16), parent) || !parse_hex(value.substr(53, 2), flags))
+    {
+      return false;
+    }
+    if ((trace_high == 0 && trace_low == 0) || parent == 0)
+    {
+      return false;
+    }
+
+    sampled = flags & 1;
+    return true;
+  }
+
+  void append_span(std::string& out, std::string_view trace_id, uint64_t span_id, uint64_t parent_id, std::string_view name,
+    int kind, int64_t start, int64_t end)
+  {
+    std::format_to(std::back_inserter(out), "{{\"traceId\":\"{}\",\"spanId\":\"{:016x}\"", trace_id, span_id);
+    if (parent_id != 0)
+    {
+      std::format_to(std::back_inserter(out), ",\"parentSpanId\":\"{:016x}\"", parent_id);
+    }
+    std::format_to(std::back_inserter(out), ",\"name\":\"{}\",\"kind\":{},\"startTimeUnixNano\":\"{}\",\"endTimeUnixNano\":\"{}\"",
+      name, kind, start, end);
+  }
+}
+
+std::string_view tracing::phase_to_string(Phase phase)
+{
+  switch (phase)
+  {
+    case Phase::READ:
+      return "read";
+    case Phase::ROUTE:
+      return "route";
+    case Phase::QUEUE:
+      return "queue";
+    case Phase::HANDLER:
+      return "handler";
+    case Phase::PARSE:
+      return "parse";
+    case Phase::DATABASE:
+      return "db";
+    case Phase::SERIALIZE:
+      return "serialize";
+    case Phase::COMPRESS:
+      return "compress";
+    case Phase::WRITE:
+      return "write";
+    default:
+      return "unknown";
+  }
+}
+
+tracing::Trace::Trace(bool sampled, bool server_timing):
+  sampled_(sampled),
+  server_timing_(server_timing),
+  trace_id_high_(0),
+  trace_id_low_(0),
+  parent_span_id_(0),
+  start_(std::chrono::steady_clock::now()),
+  wall_start_(std::chrono::system_clock::now()),
+  phases_()
+{}
+
+void tracing::Trace::begin(Phase phase)
+{
+  phases_[static_cast< size_t >(phase)].start = std::chrono::steady_clock::now();
+}
+
+void tracing::Trace::end(Phase phase)
+{
+  PhaseRecord& record = phases_[static_cast< size_t >(phase)];
+  record.duration += std::chrono::steady_clock::now() - record.start;
+  record.recorded = true;
+}
+
+void tracing::Trace::add(Phase phase, std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+{
+  PhaseRecord& record = phases_[static_cast< size_t >(phase)];
+  if (!record.recorded)
+  {
+    record.start = start;
+    record.recorded = true;
+  }
+  record.duration += end - start;
+}
+
+bool tracing::Trace::is_sampled() const
+{
+  return sampled_;
+}
+
+bool tracing::Trace::has_server_timing() const
+{
+  return server_timing_;
+}
+
+std::string tracing::Trace::get_server_timing() const
+{
+  std::string value;
+  for (size_t i = 0; i != phase_count; ++i)
+  {
+    if (!phases_[i].recorded)
+    {
+      continue;
+    }
+    if (!value.empty())
+    {
+      value += ", ";
+    }
+    std::format_to(std::back_inserter(value), "{};dur={:.3f}", phase_to_string(static_cast< Phase >(i)),
+      std::chrono::duration< double, std::milli >(phases_[i].duration).count());
+  }
+  return value;
+}
+
+tracing::Tracer::Tracer(const TracingConfig& config):
+  config_(config),
+  enabled_(config.server_timing || !config.output_path.empty())
+{
+  if (!config_.output_path.empty())
+  {
+    output_.open(config_.output_path, std::ios::app);
+    if (!output_.is_open())
+    {
+      throw std::runtime_error("Can't open trace output: " + config_.output_path);
+    }
+  }
+}
+
+tracing::Tracer::~Tracer()
+{
+  std::lock_guard< std::mutex > lock(output_mutex_);
+  if (output_.is_open())
+  {
+    output_.flush();
+  }
+}
+
+std::unique_ptr< tracing::Trace > tracing::Tracer::start(std::string_view traceparent)
+{
+  uint64_t trace_high = 0;
+  uint64_t trace_low = 0;
+  uint64_t parent = 0;
+  bool sampled = false;
+
+  if (!config_.output_path.empty())
+  {
+    if (!parse_traceparent(traceparent, trace_high, trace_low, parent, sampled))
+    {
+      trace_high = 0;
+      trace_low = 0;
+      parent = 0;
+      sampled = config_.sample_ratio > 0.0 &&
+        std::uniform_real_distribution< double >(0.0, 1.0)(get_random()) < config_.sample_ratio;
+    }
+  }
+
+  if (!sampled && !config_.server_timing)
+  {
+    return nullptr;
+  }
+
+  auto trace = std::make_unique< Trace >(sampled, config_.server_timing);
+  if (sampled)
+  {
+    trace->trace_id_high_ = trace_high != 0 || trace_low != 0 ? trace_high : make_id();
+    trace->trace_id_low_ = trace_high != 0 || trace_low != 0 ? trace_low : make_id();
+    trace->parent_span_id_ = parent;
+  }
+  return trace;
+}
+
+void tracing::Tracer::finish(const Trace& trace, std::string_view method, std::string_view route, unsigned status)
+{
+  if (!trace.sampled_)
+  {
+    return;
+  }
+
+  auto end = std::chrono::steady_clock::now();
+  int64_t wall_start = std::chrono::duration_cast< std::chrono::nanoseconds >(trace.wall_start_.time_since_epoch()).count();
+  auto to_unix_nano = [&trace, wall_start](std::chrono::steady_clock::time_point time)
+  {
+    return wall_start + std::chrono::duration_cast< std::chrono::nanoseconds >(time - trace.start_).count();
+  };
+
+  std::string trace_id = std::format("{:016x}{:016x}", trace.trace_id_high_, trace.trace_id_low_);
+  uint64_t root_id = make_id();
+  std::string name = route.empty() ? std::string(method) : std::format("{} {}", method, route);
+
+  std::string line = "{\"resourceSpans\":[{\"resource\":{\"attributes\":[{\"key\":\"service.name\","
+    "\"value\":{\"stringValue\":\"todo-server\"}}]},\"scopeSpans\":[{\"scope\":{\"name\":\"todo-server\"},\"spans\":[";
+
+  auto start = trace.start_;
+  for (size_t i = 0; i != phase_count; ++i)
+  {
+    if (trace.phases_[i].recorded)
+    {
+      start = std::min(start, trace.phases_[i].start);
+    }
+  }
+
+  append_span(line, trace_id, root_id, trace.parent_span_id_, name, 2, to_unix_nano(start), to_unix_nano(end));
+  std::format_to(std::back_inserter(line), ",\"attributes\":["
+    "{{\"key\":\"http.request.method\",\"value\":{{\"stringValue\":\"{}\"}}}},"
+    "{{\"key\":\"http.route\",\"value\":{{\"stringValue\":\"{}\"}}}},"
+    "{{\"key\":\"http.response.status_code\",\"value\":{{\"intValue\":\"{}\"}}}}],"
+    "\"status\":{{\"code\":{}}}}}", method, route, status, status >= 500 ? 2 : 0);
+
+  for (size_t i = 0; i != phase_count; ++i)
+  {
+    const Trace::PhaseRecord& record = trace.phases_[i];
+    if (!record.recorded)
+    {
+      continue;
+    }
+    line.push_back(',');
+    append_span(line, trace_id, make_id(), root_id, phase_to_string(static_cast< Phase >(i)), 1,
+      to_unix_nano(record.start), to_unix_nano(record.start) + record.duration.count());
+    line.push_back('}');
+  }
+  line += "]}]}]}\n";
+
+  std::lock_guard< std::mutex > lock(output_mutex_);
+  output_.write(line.data(), static_cast< std::streamsize >(line.size()));
+}
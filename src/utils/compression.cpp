@@ -0,0 +1,185 @@
+#include "compression.hpp"
+#include <charconv>
+#include <stdexcept>
+
+utils::Compressor::Compressor(ContentEncoding encoding, int level):
+  stream_()
+{
+  int window_bits = encoding == ContentEncoding::GZIP ? MAX_WBITS + 16 : MAX_WBITS;
+  if (deflateInit2(&stream_, level, Z_DEFLATED, window_bits, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+  {
+    throw std::runtime_error("Failed to initialize compressor");
+  }
+}
+
+utils::Compressor::~Compressor()
+{
+  deflateEnd(&stream_);
+}
+
+void utils::Compressor::compress(std::string_view input, std::string& output, bool finish)
+{
+  stream_.next_in = reinterpret_cast< Bytef* >(const_cast< char* >(input.data()));
+  stream_.avail_in = static_cast< uInt >(input.size());
+
+  int flush = finish ? Z_FINISH : Z_SYNC_FLUSH;
+  size_t chunk_size = std::max(static_cast< size_t >(deflateBound(&stream_, stream_.avail_in)), static_cast< size_t >(4096));
+
+  int result = Z_OK;
+  do
+  {
+    size_t offset = output.size();
+    output.resize(offset + chunk_size);
+
+    stream_.next_out = reinterpret_cast< Bytef* >(output.data() + offset);
+    stream_.avail_out = static_cast< uInt >(chunk_size);
+
+    result = deflate(&stream_, flush);
+    if (result == Z_STREAM_ERROR)
+    {
+      throw std::runtime_error("Failed to compress response");
+    }
+
+    output.resize(offset + chunk_size - stream_.avail_out);
+  }
+  while (stream_.avail_out == 0 || (finish && result != Z_STREAM_END));
+}
+
+utils::ContentEncoding utils::negotiate_encoding(beast::string_view accept_encoding)
+{
+  double gzip_quality = 0.0;
+  double deflate_quality = 0.0;
+  double any_quality = -1.0;
+  bool gzip_listed = false;
+  bool deflate_listed = false;
+
+  while (!accept_encoding.empty())
+  {
+    auto end = std::min(accept_encoding.find(','), accept_encoding.size());
+    beast::string_view item = accept_encoding.substr(0, end);
+    accept_encoding.remove_prefix(std::min(end + 1, accept_encoding.size()));
+
+    double quality = 1.0;
+    auto params = item.find(';');
+    beast::string_view coding = item.substr(0, params);
+    if (params != beast::string_view::npos)
+    {
+      beast::string_view param = item.substr(params + 1);
+      auto q = param.find("q=");
+      if (q != beast::string_view::npos)
+      {
+        param.remove_prefix(q + 2);
+        auto [ptr, ec] = std::from_chars(param.data(), param.data() + param.size(), quality);
+        if (ec != std::errc())
+        {
+          quality = 0.0;
+        }
+      }
+    }
+
+    while (!coding.empty() && (coding.front() == ' ' || coding.front() == '\t'))
+    {
+      coding.remove_prefix(1);
+    }
+    while (!coding.empty() && (coding.back() == ' ' || coding.back() == '\t'))
+    {
+      coding.remove_suffix(1);
+    }
+
+    if (beast::iequals(coding, "gzip") || beast::iequals(coding, "x-gzip"))
+    {
+      gzip_quality = quality;
+      gzip_listed = true;
+    }
+    else if (beast::iequals(coding, "deflate"))
+    {
+      deflate_quality = quality;
+      deflate_listed = true;
+    }
+    else if (coding == "*")
+    {
+      any_quality = quality;
+    }
+  }
+
+  if (!gzip_listed && any_quality > 0.0)
+  {
+    gzip_quality = any_quality;
+  }
+  if (!deflate_listed && any_quality > 0.0)
+  {
+    deflate_quality = any_quality;
+  }
+
+  if (gzip_quality > 0.0 && gzip_quality >= deflate_quality)
+  {
+    return ContentEncoding::GZIP;
+  }
+  if (deflate_quality > 0.0)
+  {
+    return ContentEncoding::DEFLATE;
+  }
+  return ContentEncoding::IDENTITY;
+}
+
+const char* utils::encoding_to_string(ContentEncoding encoding)
+{
+  switch (encoding)
+  {
+  case ContentEncoding::GZIP:
+    return "gzip";
+  case ContentEncoding::DEFLATE:
+    return "deflate";
+  default:
+    return "identity";
+  }
+}
+
+std::string utils::compress(std::string_view input, ContentEncoding encoding, int level)
+{
+  std::string output;
+  Compressor(encoding, level).compress(input, output, true);
+  return output;
+}
+
+std::string utils::encode_etag(beast::string_view etag, ContentEncoding encoding)
+{
+  std::string encoded(etag);
+  if (encoded.size() < 2 || encoded.back() != '"' || encoding == ContentEncoding::IDENTITY)
+  {
+    return encoded;
+  }
+  encoded.insert(encoded.size() - 1, std::string("-") + encoding_to_string(encoding));
+  return encoded;
+}
+
+bool utils::compress_response(http::response< http::string_body >& res, beast::string_view accept_encoding,
+  const CompressionConfig& config)
+{
+  if (!config.enabled || res.body().size() < config.threshold || res.count(http::field::content_encoding))
+  {
+    return false;
+  }
+  res.set(http::field::vary, "Accept-Encoding");
+
+  auto encoding = negotiate_encoding(accept_encoding);
+  if (encoding == ContentEncoding::IDENTITY)
+  {
+    return false;
+  }
+
+  std::string body = compress(res.body(), encoding, config.level);
+  if (body.size() >= res.body().size())
+  {
+    return false;
+  }
+
+  res.body() = std::move(body);
+  res.set(http::field::content_encoding, encoding_to_string(encoding));
+  if (res.count(http::field::etag))
+  {
+    res.set(http::field::etag, encode_etag(res[http::field::etag], encoding));
+  }
+  res.prepare_payload();
+  return true;
+}
@@ -1,4 +1,48 @@
 #include "http_utils.hpp"
+#include <charconv>
+
+namespace
+{
+  beast::string_view next_list_element(beast::string_view& list)
+  {
+    auto end = std::min(list.find(','), list.size());
+    beast::string_view element = list.substr(0, end);
+    list.remove_prefix(std::min(end + 1, list.size()));
+
+    while (!element.empty() && (element.front() == ' ' || element.front() == '\t'))
+    {
+      element.remove_prefix(1);
+    }
+    while (!element.empty() && (element.back() == ' ' || element.back() == '\t'))
+    {
+      element.remove_suffix(1);
+    }
+    return element;
+  }
+
+  // Compressed representations carry their coding in the ETag, so "5-gzip" names the same entity as "5"
+  beast::string_view remove_coding_suffix(beast::string_view opaque_tag)
+  {
+    for (beast::string_view suffix : { beast::string_view("-gzip"), beast::string_view("-deflate") })
+    {
+      if (opaque_tag.ends_with(suffix))
+      {
+        opaque_tag.remove_suffix(suffix.size());
+        break;
+      }
+    }
+    return opaque_tag;
+  }
+
+  beast::string_view unquote(beast::string_view tag)
+  {
+    if (tag.size() < 2 || tag.front() != '"' || tag.back() != '"')
+    {
+      return tag;
+    }
+    return tag.substr(1, tag.size() - 2);
+  }
+}
 
 http::response< http::string_body > utils::create_response(http::status status, bool is_error, const std::string& message)
 {
@@ -12,14 +56,13 @@ http::response< http::string_body > utils::create_response(http::status status,
     { "status", static_cast< int >(status) }
   };
 
-  std::string log_message = std::format("Response created. Info: {}", message);
   if (is_error)
   {
-    LOG(logger::LogLevel::ERROR, log_message);
+    LOG(logger::LogLevel::ERROR, "Response created. Info: {}", message);
   }
   else
   {
-    LOG(logger::LogLevel::INFO, std::format("Response created. Info: {}", log_message));
+    LOG(logger::LogLevel::DEBUG, "Response created. Info: {}", message);
   }
 
   res.body() = json.dump();
@@ -28,13 +71,43 @@ http::response< http::string_body > utils::create_response(http::status status,
 }
 
 http::response< http::string_body > utils::create_json_response(http::status status, const nlohmann::json& json)
+{
+  return create_raw_json_response(status, json.dump());
+}
+
+http::response< http::string_body > utils::create_raw_json_response(http::status status, std::string body)
 {
   http::response< http::string_body > res(status, 11);
   res.set(http::field::content_type, "application/json");
   res.set(http::field::access_control_allow_origin, "*");
 
-  std::string log_message = "JSON response created";
-  LOG(logger::LogLevel::INFO, log_message);
+  LOG(logger::LogLevel::DEBUG, "JSON response created");
+
+  res.body() = std::move(body);
+  res.prepare_payload();
+  return res;
+}
+
+http::response< http::string_body > utils::create_not_modified_response(const std::string& etag)
+{
+  http::response< http::string_body > res(http::status::not_modified, 11);
+  res.set(http::field::etag, etag);
+  res.set(http::field::access_control_allow_origin, "*");
+  return res;
+}
+
+http::response< http::string_body > utils::create_unavailable_response(std::chrono::seconds retry_after)
+{
+  http::response< http::string_body > res(http::status::service_unavailable, 11);
+  res.set(http::field::content_type, "application/json");
+  res.set(http::field::access_control_allow_origin, "*");
+  res.set(http::field::retry_after, std::to_string(retry_after.count()));
+
+  nlohmann::json json = {
+    { "error", true },
+    { "message", "Server overloaded" },
+    { "status", static_cast< int >(http::status::service_unavailable) }
+  };
 
   res.body() = json.dump();
   res.prepare_payload();
@@ -45,6 +118,7 @@ std::vector< std::string > utils::parse_parameters(beast::string_view target)
 {
   std::vector< std::string > params;
 
+  target = target.substr(0, target.find('?'));
   std::string target_str(target);
   std::stringstream ss(target_str);
   while (ss.good())
@@ -57,6 +131,135 @@ std::vector< std::string > utils::parse_parameters(beast::string_view target)
   return params;
 }
 
+std::unordered_map< std::string, std::string > utils::parse_query(beast::string_view target)
+{
+  std::unordered_map< std::string, std::string > query;
+
+  auto query_start = target.find('?');
+  if (query_start == beast::string_view::npos)
+  {
+    return query;
+  }
+  target.remove_prefix(query_start + 1);
+
+  auto decode = [](beast::string_view encoded)
+  {
+    std::string decoded;
+    decoded.reserve(encoded.size());
+    for (size_t i = 0; i < encoded.size(); ++i)
+    {
+      if (encoded[i] == '+')
+      {
+        decoded.push_back(' ');
+      }
+      else if (encoded[i] == '%' && i + 2 < encoded.size() &&
+        std::isxdigit(static_cast< unsigned char >(encoded[i + 1])) &&
+        std::isxdigit(static_cast< unsigned char >(encoded[i + 2])))
+      {
+        unsigned int value = 0;
+        std::from_chars(encoded.data() + i + 1, encoded.data() + i + 3, value, 16);
+        decoded.push_back(static_cast< char >(value));
+        i += 2;
+      }
+      else
+      {
+        decoded.push_back(encoded[i]);
+      }
+    }
+    return decoded;
+  };
+
+  while (!target.empty())
+  {
+    auto pair_end = std::min(target.find('&'), target.size());
+    auto pair = target.substr(0, pair_end);
+    target.remove_prefix(std::min(pair_end + 1, target.size()));
+
+    if (pair.empty())
+    {
+      continue;
+    }
+
+    auto separator = pair.find('=');
+    if (separator == beast::string_view::npos)
+    {
+      query[decode(pair)] = "";
+    }
+    else
+    {
+      query[decode(pair.substr(0, separator))] = decode(pair.substr(separator + 1));
+    }
+  }
+
+  return query;
+}
+
+std::string utils::make_version_tag(int version)
+{
+  return '"' + std::to_string(version) + '"';
+}
+
+std::optional< std::vector< int > > utils::parse_if_match(beast::string_view if_match)
+{
+  std::vector< int > versions;
+  while (!if_match.empty())
+  {
+    beast::string_view tag = next_list_element(if_match);
+    if (tag.empty())
+    {
+      continue;
+    }
+
+    bool weak = tag.starts_with("W/");
+    if (weak)
+    {
+      tag.remove_prefix(2);
+    }
+    if (tag.size() < 2 || tag.front() != '"' || tag.back() != '"')
+    {
+      return std::nullopt;
+    }
+    tag = remove_coding_suffix(tag.substr(1, tag.size() - 2));
+
+    // If-Match uses strong comparison, so weak tags and tags this server never issued can't match
+    int version = 0;
+    auto [ptr, ec] = std::from_chars(tag.data(), tag.data() + tag.size(), version);
+    if (!weak && ec == std::errc() && ptr == tag.data() + tag.size())
+    {
+      versions.push_back(version);
+    }
+  }
+  return versions;
+}
+
+std::string utils::make_etag(std::string_view value)
+{
+  std::string etag;
+  etag.reserve(value.size() + 2);
+  etag.push_back('"');
+  etag += value;
+  etag.push_back('"');
+  return etag;
+}
+
+bool utils::match_etag(beast::string_view if_none_match, beast::string_view etag)
+{
+  while (!if_none_match.empty())
+  {
+    beast::string_view tag = next_list_element(if_none_match);
+    if (tag.starts_with("W/"))
+    {
+      tag.remove_prefix(2);
+    }
+
+    if (tag == "*" || tag == etag || remove_coding_suffix(unquote(tag)) == unquote(etag))
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
 bool utils::check_task_status(const std::string& status)
 {
   return string_to_status(status) == TaskStatus::UNKNOWN;
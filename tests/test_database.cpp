@@ -1,4 +1,5 @@
 #include "test_utils.hpp"
+#include <random>
 
 namespace tests
 {
@@ -20,6 +21,26 @@ namespace tests
     EXPECT_EQ(result_task->get_status().value(), "In progress");
   }
 
+  TEST_F(TestDatabaseFixture, CreateTasks)
+  {
+    std::vector< database::Task > tasks(3);
+    for (size_t i = 0; i != tasks.size(); ++i)
+    {
+      tasks[i].set_title("Title " + std::to_string(i));
+      tasks[i].set_status("Todo");
+    }
+
+    auto ids = db_->create_tasks(tasks);
+    ASSERT_EQ(ids.size(), 3);
+
+    for (size_t i = 0; i != ids.size(); ++i)
+    {
+      auto result_task = db_->get_task_by_id(ids[i]);
+      ASSERT_TRUE(result_task);
+      EXPECT_EQ(result_task->get_title(), "Title " + std::to_string(i));
+    }
+  }
+
   TEST_F(TestDatabaseFixture, GetAllTasks)
   {
     database::Task task1;
@@ -39,6 +60,197 @@ namespace tests
     EXPECT_EQ(tasks[1].get_title().value(), "Title 2");
   }
 
+  TEST_F(TestDatabaseFixture, GetTasksPages)
+  {
+    for (int i = 0; i != 5; ++i)
+    {
+      database::Task task;
+      task.set_title("Title " + std::to_string(i));
+      task.set_status(i % 2 ? "Todo" : "Completed");
+      db_->create_task(task);
+    }
+
+    database::TaskQuery query;
+    query.limit = 2;
+
+    std::vector< int > ids;
+    size_t pages = 0;
+    do
+    {
+      auto page = db_->get_tasks(query);
+      ASSERT_LE(page.tasks.size(), 2);
+      for (const auto& task : page.tasks)
+      {
+        ids.push_back(task.get_id().value());
+      }
+      query.cursor = page.next_cursor;
+      ++pages;
+    }
+    while (query.cursor);
+
+    EXPECT_EQ(pages, 3);
+    ASSERT_EQ(ids.size(), 5);
+    EXPECT_TRUE(std::is_sorted(ids.rbegin(), ids.rend()));
+
+    query = {};
+    query.status = "todo";
+    auto page = db_->get_tasks(query);
+    EXPECT_EQ(page.tasks.size(), 2);
+    EXPECT_FALSE(page.next_cursor);
+
+    page = db_->get_tasks({});
+    EXPECT_EQ(page.tasks.size(), 5);
+    EXPECT_FALSE(page.next_cursor);
+  }
+
+  TEST_F(TestDatabaseFixture, LimitsConcurrentStreams)
+  {
+    database::DatabaseConfig config;
+    config.pool.max_size = 4;
+    config.max_streams = 1;
+    auto db = std::make_shared< database::Database >(connection_string_, config);
+    db->initialize_database();
+
+    auto stream = db->stream_tasks(std::nullopt, 16);
+    ASSERT_TRUE(stream);
+    EXPECT_FALSE(db->stream_tasks(std::nullopt, 16));
+
+    stream.reset();
+    EXPECT_TRUE(db->stream_tasks(std::nullopt, 16));
+
+    config.pool.max_size = 1;
+    config.max_streams = 0;
+    auto single_connection_db = std::make_shared< database::Database >(connection_string_, config);
+    single_connection_db->initialize_database();
+    EXPECT_FALSE(single_connection_db->stream_tasks(std::nullopt, 16));
+  }
+
+  TEST(TaskCursorTest, EncodeDecode)
+  {
+    database::TaskCursor cursor{ 1700000000, 42 };
+    auto decoded = database::decode_cursor(database::encode_cursor(cursor));
+    ASSERT_TRUE(decoded);
+    EXPECT_EQ(decoded->created_at, cursor.created_at);
+    EXPECT_EQ(decoded->id, cursor.id);
+
+    EXPECT_FALSE(database::decode_cursor("garbage"));
+    EXPECT_FALSE(database::decode_cursor("12.zz"));
+  }
+
+  TEST(TaskJsonTest, MatchesNlohmannDump)
+  {
+    std::vector< database::Task > tasks;
+    tasks.emplace_back(1, "Title", "Description", "Todo", std::chrono::system_clock::time_point());
+    tasks.emplace_back(2, "Quote \" and \\ slash", "Line\nbreak\ttab\x01\x1f", "In progress",
+      std::chrono::system_clock::time_point(std::chrono::seconds(1700000000)));
+    tasks.emplace_back(3, "Юникод ✓ 😀", "", "Completed",
+      std::chrono::system_clock::time_point(std::chrono::seconds(-86399)));
+    tasks.back().set_version(7);
+
+    for (const auto& task : tasks)
+    {
+      std::string buffer;
+      database::append_json(buffer, task);
+      EXPECT_EQ(buffer, nlohmann::json(task).dump());
+    }
+
+    std::string buffer;
+    database::append_json(buffer, tasks);
+    EXPECT_EQ(buffer, nlohmann::json(tasks).dump());
+
+    std::string timestamp;
+    database::append_timestamp(timestamp, std::chrono::system_clock::time_point(std::chrono::seconds(951782400)));
+    EXPECT_EQ(timestamp, "2000-02-29 00:00:00");
+
+    database::Task invalid(4, "\xff", "", "Todo", std::chrono::system_clock::time_point());
+    buffer.clear();
+    EXPECT_THROW(database::append_json(buffer, invalid), std::invalid_argument);
+  }
+
+  TEST(TaskJsonTest, ParseMatchesNlohmann)
+  {
+    auto parse_reference = [](const std::string& body, database::Task& task) -> std::string
+    {
+      try
+      {
+        database::from_json(nlohmann::json::parse(body), task);
+        return "ok";
+      }
+      catch (const nlohmann::json::parse_error&)
+      {
+        return "Wrong JSON format";
+      }
+      catch (const std::exception& e)
+      {
+        return e.what();
+      }
+    };
+
+    auto parse = [](const std::string& body, database::Task& task) -> std::string
+    {
+      try
+      {
+        database::parse_task(body, task);
+        return "ok";
+      }
+      catch (const database::JsonFormatError&)
+      {
+        return "Wrong JSON format";
+      }
+      catch (const std::exception& e)
+      {
+        return e.what();
+      }
+    };
+
+    std::vector< std::string > keys = { "id", "title", "description", "status", "version", "created_at", "extra" };
+    std::vector< std::string > values = { "1", "-5", "2.7", "true", "null", R"("Todo")", R"("a\nb\"c")",
+      R"("é😀")", "[1,2]", R"({"a":[]})", R"("2024-01-02T03:04:05Z")", R"("bad date")", "1e3", R"("")" };
+    std::string noise = "{}[],:\"\\ tx\n";
+
+    std::mt19937 rng(7);
+    for (int i = 0; i != 20000; ++i)
+    {
+      std::string body = "{";
+      int fields = rng() % 6;
+      for (int j = 0; j != fields; ++j)
+      {
+        body += (j == 0 ? "\"" : ",\"") + keys[rng() % keys.size()] + "\":" + values[rng() % values.size()];
+      }
+      body += "}";
+
+      switch (rng() % 5)
+      {
+      case 0:
+        body.resize(rng() % (body.size() + 1));
+        break;
+      case 1:
+        body.insert(body.begin() + rng() % (body.size() + 1), noise[rng() % noise.size()]);
+        break;
+      case 2:
+        body = "[" + body + "]";
+        break;
+      default:
+        break;
+      }
+
+      database::Task expected;
+      database::Task actual;
+      auto expected_result = parse_reference(body, expected);
+      ASSERT_EQ(parse(body, actual), expected_result) << body;
+
+      if (expected_result == "ok")
+      {
+        EXPECT_EQ(actual.get_id(), expected.get_id()) << body;
+        EXPECT_EQ(actual.get_title(), expected.get_title()) << body;
+        EXPECT_EQ(actual.get_description(), expected.get_description()) << body;
+        EXPECT_EQ(actual.get_status(), expected.get_status()) << body;
+        EXPECT_EQ(actual.get_version(), expected.get_version()) << body;
+        EXPECT_LT(std::chrono::abs(actual.get_created_at() - expected.get_created_at()), std::chrono::seconds(5)) << body;
+      }
+    }
+  }
+
   TEST_F(TestDatabaseFixture, UpdateTask)
   {
     database::Task task;
@@ -84,7 +296,50 @@ namespace tests
     task.set_description("Description");
     task.set_status("In progress");
 
-    ASSERT_THROW(db_->update_task(task), std::runtime_error);
+    ASSERT_THROW(db_->update_task(task), database::TaskNotFoundError);
+  }
+
+  TEST_F(TestDatabaseFixture, UpdateTaskVersion)
+  {
+    database::Task task;
+    task.set_title("Title");
+    task.set_status("Todo");
+    int id = db_->create_task(task);
+
+    auto created_task = db_->get_task_by_id(id);
+    ASSERT_TRUE(created_task);
+    EXPECT_EQ(created_task->get_version(), 1);
+
+    database::Task updated_task;
+    updated_task.set_id(id);
+    updated_task.set_status("Completed");
+    updated_task.set_version(1);
+    EXPECT_EQ(db_->update_task(updated_task), 2);
+
+    auto result_task = db_->get_task_by_id(id);
+    ASSERT_TRUE(result_task);
+    EXPECT_EQ(result_task->get_title(), "Title");
+    EXPECT_EQ(result_task->get_status(), "Completed");
+    EXPECT_EQ(result_task->get_version(), 2);
+  }
+
+  TEST_F(TestDatabaseFixture, UpdateTaskVersionConflict)
+  {
+    database::Task task;
+    task.set_title("Title");
+    task.set_status("Todo");
+    int id = db_->create_task(task);
+
+    database::Task updated_task;
+    updated_task.set_id(id);
+    updated_task.set_title("New Title");
+    updated_task.set_version(5);
+    ASSERT_THROW(db_->update_task(updated_task), database::VersionConflictError);
+
+    auto result_task = db_->get_task_by_id(id);
+    ASSERT_TRUE(result_task);
+    EXPECT_EQ(result_task->get_title(), "Title");
+    EXPECT_EQ(result_task->get_version(), 1);
   }
 
   TEST_F(TestDatabaseFixture, GetNonExistentTask)
@@ -110,6 +365,197 @@ namespace tests
 
   TEST_F(TestDatabaseFixture, DeleteNonExistentTask)
   {
-    ASSERT_THROW(db_->delete_task(1000000), std::runtime_error);
+    ASSERT_THROW(db_->delete_task(1000000), database::TaskNotFoundError);
+  }
+
+  TEST_F(TestDatabaseFixture, ConcurrentCreateTasks)
+  {
+    std::vector< std::jthread > threads;
+    for (int i = 0; i != 8; ++i)
+    {
+      threads.emplace_back([this, i]()
+      {
+        database::Task task;
+        task.set_title("Title " + std::to_string(i));
+        task.set_status("Todo");
+        db_->create_task(task);
+      });
+    }
+    threads.clear();
+
+    EXPECT_EQ(db_->get_all_tasks().size(), 8);
+
+    auto stats = db_->get_pool_stats();
+    EXPECT_GE(stats.checkouts, 9);
+    EXPECT_EQ(stats.in_use, 0);
+    EXPECT_LE(stats.size, stats.max_size);
+  }
+
+  TEST_F(TestDatabaseFixture, PoolCheckoutTimeout)
+  {
+    database::PoolConfig config;
+    config.min_size = 0;
+    config.max_size = 1;
+    config.checkout_timeout = std::chrono::milliseconds(50);
+    database::ConnectionPool pool(connection_string_, config);
+
+    auto connection = pool.acquire();
+    EXPECT_THROW(pool.acquire(), std::runtime_error);
+
+    auto stats = pool.get_stats();
+    EXPECT_EQ(stats.size, 1);
+    EXPECT_EQ(stats.in_use, 1);
+    EXPECT_EQ(stats.timeouts, 1);
+    EXPECT_DOUBLE_EQ(stats.utilization(), 1.0);
+  }
+
+  TEST_F(TestDatabaseFixture, ReinitializeDatabase)
+  {
+    database::Task task;
+    task.set_title("Title");
+    task.set_status("Todo");
+    int first_id = db_->create_task(task);
+
+    db_->initialize_database();
+
+    int second_id = db_->create_task(task);
+    EXPECT_GT(second_id, first_id);
+    EXPECT_TRUE(db_->get_task_by_id(first_id));
+  }
+
+  TEST(TaskCacheTest, EvictsLeastRecentlyUsed)
+  {
+    database::TaskCache cache(2, 1);
+
+    cache.put(1, database::Task(1), cache.get_epoch(1));
+    cache.put(2, database::Task(2), cache.get_epoch(2));
+    ASSERT_TRUE(cache.get(1));
+    cache.put(3, database::Task(3), cache.get_epoch(3));
+
+    EXPECT_TRUE(cache.get(1));
+    EXPECT_FALSE(cache.get(2));
+    EXPECT_TRUE(cache.get(3));
+
+    auto stats = cache.get_stats();
+    EXPECT_EQ(stats.size, 2);
+    EXPECT_EQ(stats.evictions, 1);
+    EXPECT_EQ(stats.hits, 3);
+    EXPECT_EQ(stats.misses, 1);
+  }
+
+  TEST(TaskCacheTest, RejectsStaleFill)
+  {
+    database::TaskCache cache(16, 4);
+
+    uint64_t epoch = cache.get_epoch(1);
+    cache.invalidate(1);
+    cache.put(1, database::Task(1), epoch);
+
+    EXPECT_FALSE(cache.get(1));
+  }
+
+  TEST_F(TestDatabaseFixture, CachedTaskInvalidation)
+  {
+    database::DatabaseConfig config;
+    config.cache_capacity = 100;
+    auto db = std::make_shared< database::Database >(connection_string_, config);
+    db->initialize_database();
+
+    database::Task task;
+    task.set_title("Title");
+    task.set_status("Todo");
+    int id = db->create_task(task);
+
+    ASSERT_TRUE(db->get_task_by_id(id));
+    ASSERT_TRUE(db->get_task_by_id(id));
+    EXPECT_EQ(db->get_cache_stats().hits, 1);
+
+    database::Task updated_task;
+    updated_task.set_id(id);
+    updated_task.set_title("New Title");
+    db->update_task(updated_task);
+    EXPECT_EQ(db->get_task_by_id(id)->get_title(), "New Title");
+
+    pqxx::connection connection(connection_string_);
+    pqxx::work txn(connection);
+    txn.exec("UPDATE tasks SET title = 'External Title' WHERE id = " + std::to_string(id));
+    txn.commit();
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (db->get_task_by_id(id)->get_title() != "External Title" && std::chrono::steady_clock::now() < deadline)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    EXPECT_EQ(db->get_task_by_id(id)->get_title(), "External Title");
+  }
+
+  TEST(GroupCommitterTest, CoalescesConcurrentSubmits)
+  {
+    std::atomic< int > next_id = 1;
+    database::GroupCommitConfig config;
+    config.enabled = true;
+    config.window = std::chrono::milliseconds(20);
+    config.max_batch_size = 4;
+
+    database::GroupCommitter committer(config, [&next_id](const std::vector< database::Task >& tasks)
+    {
+      std::vector< int > ids;
+      for (size_t i = 0; i != tasks.size(); ++i)
+      {
+        ids.push_back(next_id++);
+      }
+      return ids;
+    });
+
+    std::vector< int > ids(8);
+    std::vector< std::jthread > threads;
+    for (size_t i = 0; i != ids.size(); ++i)
+    {
+      threads.emplace_back([&committer, &ids, i]()
+      {
+        ids[i] = committer.submit(database::Task());
+      });
+    }
+    threads.clear();
+
+    std::sort(ids.begin(), ids.end());
+    EXPECT_EQ(std::adjacent_find(ids.begin(), ids.end()), ids.end());
+
+    auto stats = committer.get_stats();
+    EXPECT_EQ(stats.tasks, 8);
+    EXPECT_LT(stats.batches, 8);
+    EXPECT_LE(stats.largest_batch, 4);
+  }
+
+  TEST_F(TestDatabaseFixture, GroupCommitCreateTasks)
+  {
+    database::DatabaseConfig config;
+    config.group_commit.enabled = true;
+    config.pool.max_size = 2;
+    auto db = std::make_shared< database::Database >(connection_string_, config);
+    db->initialize_database();
+
+    std::vector< int > ids(16);
+    std::vector< std::jthread > threads;
+    for (size_t i = 0; i != ids.size(); ++i)
+    {
+      threads.emplace_back([&db, &ids, i]()
+      {
+        database::Task task;
+        task.set_title("Title " + std::to_string(i));
+        task.set_status("Todo");
+        ids[i] = db->create_task(task);
+      });
+    }
+    threads.clear();
+
+    for (size_t i = 0; i != ids.size(); ++i)
+    {
+      auto result_task = db->get_task_by_id(ids[i]);
+      ASSERT_TRUE(result_task);
+      EXPECT_EQ(result_task->get_title(), "Title " + std::to_string(i));
+    }
+
+    EXPECT_EQ(db->get_group_commit_stats().tasks, 16);
   }
 }
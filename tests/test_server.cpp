@@ -1,7 +1,43 @@
 #include "test_utils.hpp"
+#include <filesystem>
+#include <fstream>
+#include "post_tasks_batch_handler.hpp"
 
 namespace tests
 {
+  namespace
+  {
+    // A 100 Continue for a pipelined request may only follow the responses to the requests before it
+    void expect_continue_after_pipelined(const std::string& host, unsigned short port)
+    {
+      net::io_context ioc;
+      beast::tcp_stream stream(ioc);
+      stream.connect(tcp::endpoint(net::ip::make_address(host), port));
+
+      std::string body = nlohmann::json({ { "title", "Title" }, { "status", "Todo" } }).dump();
+      std::string requests = "GET /tasks HTTP/1.1\r\nHost: localhost\r\n\r\n"
+        "POST /task HTTP/1.1\r\nHost: localhost\r\nContent-Type: application/json\r\n"
+        "Expect: 100-continue\r\nContent-Length: " + std::to_string(body.size()) + "\r\n\r\n";
+      net::write(stream, net::buffer(requests));
+
+      beast::flat_buffer buffer;
+      http::response< http::string_body > response;
+      stream.expires_after(std::chrono::seconds(5));
+      ASSERT_NO_THROW(http::read(stream, buffer, response));
+      ASSERT_EQ(response.result(), http::status::ok);
+
+      response = {};
+      ASSERT_NO_THROW(http::read(stream, buffer, response));
+      ASSERT_EQ(response.result(), http::status::continue_);
+
+      net::write(stream, net::buffer(body));
+
+      response = {};
+      ASSERT_NO_THROW(http::read(stream, buffer, response));
+      EXPECT_EQ(response.result(), http::status::created);
+    }
+  }
+
   TEST_F(TestServerFixture, GetEmptyTasks)
   {
     HttpClient client(server_host_, server_port_);
@@ -16,6 +52,89 @@ namespace tests
     EXPECT_TRUE(json.empty());
   }
 
+  TEST_F(TestServerFixture, GetTasksPage)
+  {
+    HttpClient client(server_host_, server_port_);
+
+    for (int i = 0; i != 3; ++i)
+    {
+      nlohmann::json create_json = {
+        { "title", "Title " + std::to_string(i) },
+        { "status", "Todo" }
+      };
+      ASSERT_EQ(client.request(http::verb::post, "/task", create_json).result(), http::status::created);
+    }
+
+    http::response< http::string_body > response;
+    ASSERT_NO_THROW(response = client.request(http::verb::get, "/tasks?limit=2&status=todo"));
+
+    ASSERT_EQ(response.result(), http::status::ok);
+    EXPECT_EQ(nlohmann::json::parse(response.body()).size(), 2);
+
+    std::string cursor(response["X-Next-Cursor"]);
+    ASSERT_FALSE(cursor.empty());
+
+    ASSERT_NO_THROW(response = client.request(http::verb::get, "/tasks?limit=2&cursor=" + cursor));
+
+    ASSERT_EQ(response.result(), http::status::ok);
+    EXPECT_EQ(nlohmann::json::parse(response.body()).size(), 1);
+    EXPECT_TRUE(response["X-Next-Cursor"].empty());
+
+    ASSERT_NO_THROW(response = client.request(http::verb::get, "/tasks?limit=0"));
+    EXPECT_EQ(response.result(), http::status::bad_request);
+  }
+
+  TEST_F(TestServerFixture, GetTasksStream)
+  {
+    HttpClient client(server_host_, server_port_);
+
+    for (int i = 0; i != 3; ++i)
+    {
+      nlohmann::json create_json = {
+        { "title", "Title " + std::to_string(i) },
+        { "status", "Todo" }
+      };
+      ASSERT_EQ(client.request(http::verb::post, "/task", create_json).result(), http::status::created);
+    }
+
+    http::response< http::string_body > response;
+    ASSERT_NO_THROW(response = client.request(http::verb::get, "/tasks?stream=true"));
+
+    ASSERT_EQ(response.result(), http::status::ok);
+    EXPECT_TRUE(response.chunked());
+
+    auto json = nlohmann::json::parse(response.body());
+    ASSERT_TRUE(json.is_array());
+    EXPECT_EQ(json.size(), 3);
+
+    ASSERT_NO_THROW(response = client.request(http::verb::get, "/tasks"));
+    EXPECT_EQ(response.result(), http::status::ok);
+  }
+
+  TEST_F(TestDatabaseFixture, RejectsStreamOverLimit)
+  {
+    database::DatabaseConfig db_config;
+    db_config.pool.max_size = 1;
+    auto db = std::make_shared< database::Database >(connection_string_, db_config);
+    db->initialize_database();
+
+    server::Server server("127.0.0.1", 9005, 2, db);
+    server.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    HttpClient client("127.0.0.1", 9005);
+
+    http::response< http::string_body > response;
+    ASSERT_NO_THROW(response = client.request(http::verb::get, "/tasks?stream=true"));
+    EXPECT_EQ(response.result(), http::status::service_unavailable);
+    EXPECT_EQ(response[http::field::retry_after], "1");
+
+    ASSERT_NO_THROW(response = client.request(http::verb::get, "/tasks"));
+    EXPECT_EQ(response.result(), http::status::ok);
+
+    server.stop();
+  }
+
   TEST_F(TestServerFixture, CreateAndGetTask)
   {
     HttpClient client(server_host_, server_port_);
@@ -131,6 +250,12 @@ namespace tests
     EXPECT_EQ(get_json_response["message"].get< std::string >(), "No task with current id");
   }
 
+  TEST_F(TestServerFixture, RestartAfterStop)
+  {
+    server_->stop();
+    EXPECT_THROW(server_->start(), std::logic_error);
+  }
+
   TEST_F(TestServerFixture, InvalidJson)
   {
     HttpClient client(server_host_, server_port_);
@@ -150,4 +275,565 @@ namespace tests
 
     EXPECT_EQ(response.result(), http::status::not_found);
   }
+
+  TEST_F(TestServerFixture, CreateTasksBatch)
+  {
+    HttpClient client(server_host_, server_port_);
+
+    nlohmann::json batch_json = nlohmann::json::array({
+      { { "title", "Title 1" }, { "status", "Todo" } },
+      { { "title", "" }, { "status", "Todo" } },
+      { { "title", "Title 3" }, { "status", "Completed" } }
+    });
+
+    http::response< http::string_body > response;
+    ASSERT_NO_THROW(response = client.request(http::verb::post, "/tasks/batch", batch_json));
+
+    ASSERT_EQ(response.result(), http::status::created);
+
+    auto json = nlohmann::json::parse(response.body());
+    ASSERT_EQ(json["created"].size(), 2);
+    ASSERT_EQ(json["errors"].size(), 1);
+    EXPECT_EQ(json["errors"][0]["index"].get< int >(), 1);
+    EXPECT_EQ(json["errors"][0]["message"].get< std::string >(), "Wrong title");
+
+    int task_id = json["created"][1]["id"].get< int >();
+    EXPECT_EQ(json["created"][1]["index"].get< int >(), 2);
+
+    ASSERT_NO_THROW(response = client.request(http::verb::get, "/task/" + std::to_string(task_id)));
+    ASSERT_EQ(response.result(), http::status::ok);
+    EXPECT_EQ(nlohmann::json::parse(response.body())["title"].get< std::string >(), "Title 3");
+
+    nlohmann::json large_batch = nlohmann::json::array();
+    for (size_t i = 0; i != handlers::PostTasksBatchHandler::max_batch_size + 1; ++i)
+    {
+      large_batch.push_back({ { "title", "Title" } });
+    }
+    ASSERT_NO_THROW(response = client.request(http::verb::post, "/tasks/batch", large_batch));
+    EXPECT_EQ(response.result(), http::status::payload_too_large);
+  }
+
+  TEST_F(TestServerFixture, RejectsLargeBody)
+  {
+    net::io_context ioc;
+    beast::tcp_stream stream(ioc);
+    stream.connect(tcp::endpoint(net::ip::make_address(server_host_), server_port_));
+
+    std::string request = "POST /task HTTP/1.1\r\nHost: localhost\r\nContent-Type: application/json\r\n"
+      "Content-Length: 1000000000\r\n\r\n";
+    net::write(stream, net::buffer(request));
+
+    beast::flat_buffer buffer;
+    http::response< http::string_body > response;
+    stream.expires_after(std::chrono::seconds(5));
+    ASSERT_NO_THROW(http::read(stream, buffer, response));
+
+    EXPECT_EQ(response.result(), http::status::payload_too_large);
+    EXPECT_FALSE(response.keep_alive());
+  }
+
+  TEST_F(TestServerFixture, ExpectContinue)
+  {
+    net::io_context ioc;
+    beast::tcp_stream stream(ioc);
+    stream.connect(tcp::endpoint(net::ip::make_address(server_host_), server_port_));
+
+    std::string body = nlohmann::json({ { "title", "Title" }, { "status", "Todo" } }).dump();
+    std::string request = "POST /task HTTP/1.1\r\nHost: localhost\r\nContent-Type: application/json\r\n"
+      "Expect: 100-continue\r\nContent-Length: " + std::to_string(body.size()) + "\r\n\r\n";
+    net::write(stream, net::buffer(request));
+
+    beast::flat_buffer buffer;
+    http::response< http::string_body > response;
+    stream.expires_after(std::chrono::seconds(5));
+    ASSERT_NO_THROW(http::read(stream, buffer, response));
+    ASSERT_EQ(response.result(), http::status::continue_);
+
+    net::write(stream, net::buffer(body));
+
+    response = {};
+    ASSERT_NO_THROW(http::read(stream, buffer, response));
+    EXPECT_EQ(response.result(), http::status::created);
+  }
+
+  TEST_F(TestServerFixture, PipelinedExpectContinue)
+  {
+    expect_continue_after_pipelined(server_host_, server_port_);
+  }
+
+  TEST_F(TestDatabaseFixture, CoroutinePipelinedExpectContinue)
+  {
+    server::ServerConfig config;
+    config.session_mode = server::SessionMode::COROUTINE;
+
+    server::Server server("127.0.0.1", 9006, 2, db_, config);
+    server.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    expect_continue_after_pipelined("127.0.0.1", 9006);
+
+    server.stop();
+  }
+
+  TEST_F(TestServerFixture, PipelinedRequests)
+  {
+    HttpClient client(server_host_, server_port_);
+
+    std::vector< std::string > ids;
+    for (int i = 0; i != 3; ++i)
+    {
+      nlohmann::json create_json = {
+        { "title", "Title " + std::to_string(i) },
+        { "status", "Todo" }
+      };
+      auto response = client.request(http::verb::post, "/task", create_json);
+      ASSERT_EQ(response.result(), http::status::created);
+      ids.push_back(nlohmann::json::parse(response.body())["message"]);
+    }
+
+    net::io_context ioc;
+    beast::tcp_stream stream(ioc);
+    stream.connect(tcp::endpoint(net::ip::make_address(server_host_), server_port_));
+
+    std::string requests;
+    for (size_t i = 0; i != ids.size(); ++i)
+    {
+      requests += "GET /task/" + ids[i] + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    }
+    net::write(stream, net::buffer(requests));
+
+    beast::flat_buffer buffer;
+    for (size_t i = 0; i != ids.size(); ++i)
+    {
+      http::response< http::string_body > response;
+      stream.expires_after(std::chrono::seconds(5));
+      ASSERT_NO_THROW(http::read(stream, buffer, response));
+
+      ASSERT_EQ(response.result(), http::status::ok);
+      EXPECT_EQ(nlohmann::json::parse(response.body())["title"], "Title " + std::to_string(i));
+    }
+  }
+
+  TEST_F(TestServerFixture, PipelinedUpdateBeforeRead)
+  {
+    HttpClient client(server_host_, server_port_);
+
+    nlohmann::json create_json = {
+      { "title", "Old title" },
+      { "status", "Todo" }
+    };
+    auto create_response = client.request(http::verb::post, "/task", create_json);
+    ASSERT_EQ(create_response.result(), http::status::created);
+    std::string id = nlohmann::json::parse(create_response.body())["message"];
+
+    net::io_context ioc;
+    beast::tcp_stream stream(ioc);
+    stream.connect(tcp::endpoint(net::ip::make_address(server_host_), server_port_));
+
+    std::string update_body = nlohmann::json({
+      { "id", std::stoi(id) },
+      { "title", "New title" },
+      { "status", "In progress" }
+    }).dump();
+    std::string requests = "PUT /task HTTP/1.1\r\nHost: localhost\r\nContent-Type: application/json\r\nContent-Length: " +
+      std::to_string(update_body.size()) + "\r\n\r\n" + update_body;
+    requests += "GET /task/" + id + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    net::write(stream, net::buffer(requests));
+
+    beast::flat_buffer buffer;
+    http::response< http::string_body > update_response;
+    stream.expires_after(std::chrono::seconds(5));
+    ASSERT_NO_THROW(http::read(stream, buffer, update_response));
+    ASSERT_EQ(update_response.result(), http::status::accepted);
+
+    http::response< http::string_body > get_response;
+    stream.expires_after(std::chrono::seconds(5));
+    ASSERT_NO_THROW(http::read(stream, buffer, get_response));
+    ASSERT_EQ(get_response.result(), http::status::ok);
+    EXPECT_EQ(nlohmann::json::parse(get_response.body())["title"], "New title");
+  }
+
+  TEST_F(TestServerFixture, CompressedResponse)
+  {
+    HttpClient client(server_host_, server_port_);
+
+    for (int i = 0; i != 20; ++i)
+    {
+      nlohmann::json create_json = {
+        { "title", "Title " + std::to_string(i) },
+        { "description", "Description " + std::to_string(i) },
+        { "status", "Todo" }
+      };
+      ASSERT_EQ(client.request(http::verb::post, "/task", create_json).result(), http::status::created);
+    }
+
+    net::io_context ioc;
+    beast::tcp_stream stream(ioc);
+    stream.connect(tcp::endpoint(net::ip::make_address(server_host_), server_port_));
+
+    http::request< http::string_body > request(http::verb::get, "/tasks", 11);
+    request.set(http::field::host, server_host_);
+    request.set(http::field::accept_encoding, "deflate;q=0.5, gzip");
+    http::write(stream, request);
+
+    beast::flat_buffer buffer;
+    http::response< http::string_body > response;
+    stream.expires_after(std::chrono::seconds(5));
+    ASSERT_NO_THROW(http::read(stream, buffer, response));
+
+    ASSERT_EQ(response.result(), http::status::ok);
+    EXPECT_EQ(response[http::field::content_encoding], "gzip");
+    EXPECT_EQ(response[http::field::vary], "Accept-Encoding");
+    EXPECT_EQ(response.body().substr(0, 2), "\x1f\x8b");
+    std::string etag(response[http::field::etag]);
+    EXPECT_TRUE(etag.ends_with("-gzip\""));
+
+    request.set(http::field::if_none_match, etag);
+    http::write(stream, request);
+    http::response< http::string_body > not_modified;
+    stream.expires_after(std::chrono::seconds(5));
+    ASSERT_NO_THROW(http::read(stream, buffer, not_modified));
+    EXPECT_EQ(not_modified.result(), http::status::not_modified);
+  }
+
+  TEST(CompressionTest, NegotiatesEncoding)
+  {
+    EXPECT_EQ(utils::negotiate_encoding(""), utils::ContentEncoding::IDENTITY);
+    EXPECT_EQ(utils::negotiate_encoding("gzip, deflate"), utils::ContentEncoding::GZIP);
+    EXPECT_EQ(utils::negotiate_encoding("gzip;q=0.2, deflate;q=0.8"), utils::ContentEncoding::DEFLATE);
+    EXPECT_EQ(utils::negotiate_encoding("gzip;q=0, *"), utils::ContentEncoding::DEFLATE);
+    EXPECT_EQ(utils::negotiate_encoding("br, identity"), utils::ContentEncoding::IDENTITY);
+  }
+
+  TEST(CompressionTest, DeflateRoundTrip)
+  {
+    std::string input;
+    for (int i = 0; i != 1000; ++i)
+    {
+      input += R"({"id":)" + std::to_string(i) + R"(,"status":"Todo","title":"Title"},)";
+    }
+
+    std::string compressed = utils::compress(input, utils::ContentEncoding::DEFLATE, 6);
+    EXPECT_LT(compressed.size(), input.size());
+
+    std::string output(input.size(), '\0');
+    uLongf output_size = output.size();
+    ASSERT_EQ(uncompress(reinterpret_cast< Bytef* >(output.data()), &output_size,
+      reinterpret_cast< const Bytef* >(compressed.data()), compressed.size()), Z_OK);
+    output.resize(output_size);
+    EXPECT_EQ(output, input);
+  }
+
+  TEST_F(TestServerFixture, ConditionalGet)
+  {
+    HttpClient client(server_host_, server_port_);
+
+    nlohmann::json create_json = {
+      { "title", "Title" },
+      { "status", "Todo" }
+    };
+    auto response = client.request(http::verb::post, "/task", create_json);
+    ASSERT_EQ(response.result(), http::status::created);
+    std::string id = nlohmann::json::parse(response.body())["message"];
+
+    response = client.request(http::verb::get, "/tasks");
+    ASSERT_EQ(response.result(), http::status::ok);
+    std::string list_etag(response[http::field::etag]);
+    ASSERT_FALSE(list_etag.empty());
+
+    response = client.request(http::verb::get, "/tasks", {}, { { http::field::if_none_match, list_etag } });
+    EXPECT_EQ(response.result(), http::status::not_modified);
+    EXPECT_TRUE(response.body().empty());
+
+    response = client.request(http::verb::get, "/task/" + id);
+    ASSERT_EQ(response.result(), http::status::ok);
+    std::string task_etag(response[http::field::etag]);
+    EXPECT_EQ(task_etag, utils::make_version_tag(1));
+
+    response = client.request(http::verb::get, "/task/" + id, {}, { { http::field::if_none_match, task_etag } });
+    EXPECT_EQ(response.result(), http::status::not_modified);
+
+    nlohmann::json update_json = {
+      { "id", std::stoi(id) },
+      { "status", "Completed" }
+    };
+    ASSERT_EQ(client.request(http::verb::put, "/task", update_json).result(), http::status::accepted);
+
+    response = client.request(http::verb::get, "/task/" + id, {}, { { http::field::if_none_match, task_etag } });
+    EXPECT_EQ(response.result(), http::status::ok);
+    EXPECT_EQ(response[http::field::etag], utils::make_version_tag(2));
+
+    response = client.request(http::verb::get, "/tasks", {}, { { http::field::if_none_match, list_etag } });
+    EXPECT_EQ(response.result(), http::status::ok);
+    EXPECT_NE(response[http::field::etag], list_etag);
+  }
+
+  TEST(HttpUtilsTest, MatchesEtag)
+  {
+    EXPECT_TRUE(utils::match_etag("\"1\"", "\"1\""));
+    EXPECT_TRUE(utils::match_etag("\"2\", W/\"1\"", "\"1\""));
+    EXPECT_TRUE(utils::match_etag("*", "\"1\""));
+    EXPECT_FALSE(utils::match_etag("\"2\"", "\"1\""));
+    EXPECT_FALSE(utils::match_etag("", "\"1\""));
+    EXPECT_TRUE(utils::match_etag("\"1-gzip\"", "\"1\""));
+    EXPECT_TRUE(utils::match_etag("W/\"1-deflate\"", "\"1\""));
+    EXPECT_FALSE(utils::match_etag("\"11-gzip\"", "\"1\""));
+  }
+
+  TEST(CompressionTest, EncodesEtag)
+  {
+    EXPECT_EQ(utils::encode_etag("\"1\"", utils::ContentEncoding::GZIP), "\"1-gzip\"");
+    EXPECT_EQ(utils::encode_etag("\"1\"", utils::ContentEncoding::DEFLATE), "\"1-deflate\"");
+    EXPECT_EQ(utils::encode_etag("\"1\"", utils::ContentEncoding::IDENTITY), "\"1\"");
+  }
+
+  TEST(HttpUtilsTest, ParsesIfMatch)
+  {
+    EXPECT_EQ(utils::parse_if_match("\"1\""), std::vector< int >({ 1 }));
+    EXPECT_EQ(utils::parse_if_match("\"1\", \"2\""), std::vector< int >({ 1, 2 }));
+    EXPECT_EQ(utils::parse_if_match("W/\"1\", \"2\""), std::vector< int >({ 2 }));
+    EXPECT_EQ(utils::parse_if_match("W/\"1\""), std::vector< int >());
+    EXPECT_EQ(utils::parse_if_match("\"3-gzip\""), std::vector< int >({ 3 }));
+    EXPECT_FALSE(utils::parse_if_match("1"));
+  }
+
+  TEST_F(TestServerFixture, ConditionalUpdate)
+  {
+    HttpClient client(server_host_, server_port_);
+
+    nlohmann::json create_json = {
+      { "title", "Title" },
+      { "status", "Todo" }
+    };
+    auto response = client.request(http::verb::post, "/task", create_json);
+    ASSERT_EQ(response.result(), http::status::created);
+    int id = std::stoi(nlohmann::json::parse(response.body())["message"].get< std::string >());
+
+    nlohmann::json update_json = {
+      { "id", id },
+      { "status", "Completed" }
+    };
+    response = client.request(http::verb::put, "/task", update_json, { { http::field::if_match, "W/\"1\"" } });
+    EXPECT_EQ(response.result(), http::status::precondition_failed);
+
+    response = client.request(http::verb::put, "/task", update_json, { { http::field::if_match, "\"3\", \"1\"" } });
+    EXPECT_EQ(response.result(), http::status::accepted);
+    EXPECT_EQ(response[http::field::etag], utils::make_version_tag(2));
+  }
+
+  TEST_F(TestDatabaseFixture, ReusePortServer)
+  {
+    server::ServerConfig config;
+    config.reuse_port = true;
+
+    server::Server server("127.0.0.1", 9001, 4, db_, config);
+    server.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    for (int i = 0; i != 8; ++i)
+    {
+      HttpClient client("127.0.0.1", 9001);
+
+      http::response< http::string_body > response;
+      ASSERT_NO_THROW(response = client.request(http::verb::get, "/tasks"));
+      EXPECT_EQ(response.result(), http::status::ok);
+    }
+
+    server.stop();
+  }
+
+  TEST_F(TestDatabaseFixture, CoroutineSessionServer)
+  {
+    server::ServerConfig config;
+    config.session_mode = server::SessionMode::COROUTINE;
+
+    server::Server server("127.0.0.1", 9002, 2, db_, config);
+    server.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    HttpClient client("127.0.0.1", 9002);
+
+    nlohmann::json create_json = {
+      { "title", "Coroutine" },
+      { "status", "Todo" }
+    };
+    auto response = client.request(http::verb::post, "/task", create_json);
+    ASSERT_EQ(response.result(), http::status::created);
+    std::string id = nlohmann::json::parse(response.body())["message"];
+
+    net::io_context ioc;
+    beast::tcp_stream stream(ioc);
+    stream.connect(tcp::endpoint(net::ip::make_address("127.0.0.1"), 9002));
+
+    std::string requests;
+    requests += "GET /task/" + id + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    requests += "GET /missing HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    requests += "GET /tasks HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n";
+    net::write(stream, net::buffer(requests));
+
+    std::vector< http::status > expected = { http::status::ok, http::status::not_found, http::status::ok };
+    beast::flat_buffer buffer;
+    for (size_t i = 0; i != expected.size(); ++i)
+    {
+      http::response< http::string_body > pipelined;
+      stream.expires_after(std::chrono::seconds(5));
+      ASSERT_NO_THROW(http::read(stream, buffer, pipelined));
+      EXPECT_EQ(pipelined.result(), expected[i]);
+    }
+    EXPECT_EQ(nlohmann::json::parse(client.request(http::verb::get, "/task/" + id).body())["title"], "Coroutine");
+
+    server.stop();
+  }
+
+  TEST_F(TestDatabaseFixture, ShedsExcessSessions)
+  {
+    server::ServerConfig config;
+    config.admission.max_sessions = 1;
+    config.admission.retry_after = std::chrono::seconds(3);
+
+    server::Server server("127.0.0.1", 9003, 2, db_, config);
+    server.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    HttpClient first("127.0.0.1", 9003);
+    ASSERT_EQ(first.request(http::verb::get, "/tasks").result(), http::status::ok);
+
+    HttpClient second("127.0.0.1", 9003);
+    http::response< http::string_body > response;
+    ASSERT_NO_THROW(response = second.request(http::verb::get, "/tasks"));
+    EXPECT_EQ(response.result(), http::status::service_unavailable);
+    EXPECT_EQ(response[http::field::retry_after], "3");
+
+    auto stats = server.get_admission_stats();
+    EXPECT_EQ(stats.sessions, 1);
+    EXPECT_EQ(stats.rejected_sessions, 1);
+
+    server.stop();
+  }
+
+  TEST(AdmissionControllerTest, LimitsInflightRequests)
+  {
+    server::AdmissionConfig config;
+    config.max_inflight = 2;
+    server::AdmissionController controller(config);
+
+    auto first = controller.try_admit_request();
+    auto second = controller.try_admit_request();
+    ASSERT_TRUE(first.has_value());
+    ASSERT_TRUE(second.has_value());
+    EXPECT_FALSE(controller.try_admit_request().has_value());
+    EXPECT_EQ(controller.get_stats().inflight, 2);
+    EXPECT_EQ(controller.get_stats().shed_inflight, 1);
+
+    first.reset();
+    EXPECT_TRUE(controller.try_admit_request().has_value());
+  }
+
+  TEST(AdmissionControllerTest, ShedsOnQueueDelay)
+  {
+    server::AdmissionConfig config;
+    config.target_delay = std::chrono::milliseconds(1);
+    config.interval = std::chrono::milliseconds(1);
+    server::AdmissionController controller(config);
+
+    auto permit = controller.try_admit_request();
+    ASSERT_TRUE(permit.has_value());
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    EXPECT_FALSE(permit->start());
+
+    auto stats = controller.get_stats();
+    EXPECT_TRUE(stats.overloaded);
+    EXPECT_EQ(stats.shed_queue_delay, 1);
+  }
+
+  TEST_F(TestServerFixture, MetricsEndpoint)
+  {
+    HttpClient client(server_host_, server_port_);
+
+    ASSERT_NO_THROW(client.request(http::verb::get, "/tasks"));
+    ASSERT_NO_THROW(client.request(http::verb::get, "/not_found"));
+
+    http::response< http::string_body > response;
+    ASSERT_NO_THROW(response = client.request(http::verb::get, "/metrics"));
+
+    EXPECT_EQ(response.result(), http::status::ok);
+    EXPECT_EQ(response[http::field::content_type], "text/plain; version=0.0.4");
+    EXPECT_THAT(response.body(), ::testing::HasSubstr("todo_http_requests_total{method=\"GET\",route=\"/tasks\",code=\"2xx\"}"));
+    EXPECT_THAT(response.body(), ::testing::HasSubstr("route=\"unmatched\",code=\"4xx\"}"));
+    EXPECT_THAT(response.body(), ::testing::HasSubstr("todo_db_query_duration_seconds_count{operation=\"get_tasks\"}"));
+    EXPECT_THAT(response.body(), ::testing::HasSubstr("todo_db_pool_connections "));
+  }
+
+  TEST_F(TestDatabaseFixture, ServerTimingAndSpans)
+  {
+    std::string trace_path = (std::filesystem::temp_directory_path() / "todo_server_spans.jsonl").string();
+    std::filesystem::remove(trace_path);
+
+    server::ServerConfig config;
+    config.tracing.server_timing = true;
+    config.tracing.sample_ratio = 1.0;
+    config.tracing.output_path = trace_path;
+
+    {
+      server::Server server("127.0.0.1", 9004, 2, db_, config);
+      server.start();
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+      HttpClient client("127.0.0.1", 9004);
+
+      http::response< http::string_body > response;
+      ASSERT_NO_THROW(response = client.request(http::verb::get, "/tasks"));
+      EXPECT_THAT(std::string(response["Server-Timing"]), ::testing::HasSubstr("db;dur="));
+      EXPECT_THAT(std::string(response["Server-Timing"]), ::testing::HasSubstr("handler;dur="));
+
+      server.stop();
+    }
+
+    std::ifstream spans(trace_path);
+    std::string line;
+    ASSERT_TRUE(std::getline(spans, line));
+    EXPECT_THAT(line, ::testing::HasSubstr("\"name\":\"GET /tasks\""));
+    EXPECT_THAT(line, ::testing::HasSubstr("\"name\":\"db\""));
+  }
+
+  TEST(MetricsTest, HistogramBuckets)
+  {
+    using metrics::Histogram;
+
+    EXPECT_EQ(Histogram::bucket_index(std::chrono::microseconds(0)), 0);
+    EXPECT_EQ(Histogram::bucket_index(std::chrono::microseconds(15)), 0);
+    EXPECT_EQ(Histogram::bucket_index(std::chrono::microseconds(16)), 0);
+    EXPECT_EQ(Histogram::bucket_index(std::chrono::microseconds(16) + std::chrono::nanoseconds(1)), 1);
+    EXPECT_EQ(Histogram::bucket_index(std::chrono::microseconds(18)), 1);
+    EXPECT_EQ(Histogram::bucket_index(std::chrono::microseconds(19)), 2);
+    EXPECT_EQ(Histogram::bucket_index(std::chrono::hours(1)), Histogram::bucket_count - 1);
+
+    for (size_t i = 1; i + 1 < Histogram::bucket_count; ++i)
+    {
+      EXPECT_LT(Histogram::bucket_bound(i - 1), Histogram::bucket_bound(i));
+      auto previous = std::chrono::microseconds(std::llround(Histogram::bucket_bound(i - 1) * 1e6));
+      auto bound = std::chrono::microseconds(std::llround(Histogram::bucket_bound(i) * 1e6));
+      EXPECT_EQ(Histogram::bucket_index(previous + std::chrono::nanoseconds(1)), i);
+      EXPECT_EQ(Histogram::bucket_index(bound), i);
+    }
+  }
+
+  TEST(RouterTest, MatchesRoutes)
+  {
+    auto router = handlers::Router::create_default();
+
+    auto route = router.match(http::verb::get, "/task/42?verbose=1");
+    ASSERT_TRUE(route.has_value());
+    EXPECT_EQ(route->params.get_int("id"), 42);
+
+    route = router.match(http::verb::delete_, "/task/abc");
+    ASSERT_TRUE(route.has_value());
+    EXPECT_FALSE(route->params.get_int("id").has_value());
+
+    EXPECT_TRUE(router.match(http::verb::get, "/tasks").has_value());
+    EXPECT_TRUE(router.match(http::verb::post, "/tasks/batch").has_value());
+    EXPECT_FALSE(router.match(http::verb::put, "/task/42").has_value());
+    EXPECT_FALSE(router.match(http::verb::get, "/tasks/").has_value());
+    EXPECT_FALSE(router.match(http::verb::get, "/task/1/2").has_value());
+  }
 }
@@ -114,7 +114,8 @@ namespace tests
       disconnect();
     }
 
-    http::response< http::string_body > request(http::verb method, const std::string& target, const nlohmann::json& body = {})
+    http::response< http::string_body > request(http::verb method, const std::string& target, const nlohmann::json& body = {},
+      const std::vector< std::pair< http::field, std::string > >& headers = {})
     {
       if (!connected_)
       {
@@ -125,6 +126,10 @@ namespace tests
       req.set(http::field::host, host_);
       req.set(http::field::user_agent, "Client");
       req.set(http::field::connection, "keep-alive");
+      for (const auto& [field, value] : headers)
+      {
+        req.set(field, value);
+      }
 
       if (!body.empty())
       {